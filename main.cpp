@@ -3,9 +3,30 @@ cmake_minimum_required(VERSION 3.10)
 project(TicTacToeSFML)
 set(CMAKE_CXX_STANDARD 17)
 find_package(SFML 2.5 COMPONENTS graphics window system REQUIRED)
+find_package(Threads REQUIRED)
 add_executable(tictactoe src/main.cpp)
 target_include_directories(tictactoe PRIVATE ${CMAKE_SOURCE_DIR}/src)
-target_link_libraries(tictactoe PRIVATE sfml-graphics sfml-window sfml-system)
+target_link_libraries(tictactoe PRIVATE sfml-graphics sfml-window sfml-system Threads::Threads)
+
+add_executable(tictactoe_selfplay src/main.cpp)
+target_compile_definitions(tictactoe_selfplay PRIVATE TICTACTOE_SELFPLAY)
+target_include_directories(tictactoe_selfplay PRIVATE ${CMAKE_SOURCE_DIR}/src)
+target_link_libraries(tictactoe_selfplay PRIVATE sfml-graphics sfml-window sfml-system Threads::Threads)
+
+add_executable(tictactoe_perft src/main.cpp)
+target_compile_definitions(tictactoe_perft PRIVATE TICTACTOE_PERFT)
+target_include_directories(tictactoe_perft PRIVATE ${CMAKE_SOURCE_DIR}/src)
+target_link_libraries(tictactoe_perft PRIVATE sfml-graphics sfml-window sfml-system Threads::Threads)
+
+add_executable(tictactoe_render_bench src/main.cpp)
+target_compile_definitions(tictactoe_render_bench PRIVATE TICTACTOE_RENDER_BENCH)
+target_include_directories(tictactoe_render_bench PRIVATE ${CMAKE_SOURCE_DIR}/src)
+target_link_libraries(tictactoe_render_bench PRIVATE sfml-graphics sfml-window sfml-system Threads::Threads)
+
+add_executable(tictactoe_bench src/main.cpp)
+target_compile_definitions(tictactoe_bench PRIVATE TICTACTOE_BENCH)
+target_include_directories(tictactoe_bench PRIVATE ${CMAKE_SOURCE_DIR}/src)
+target_link_libraries(tictactoe_bench PRIVATE sfml-graphics sfml-window sfml-system Threads::Threads)
 
 --- README.md ---
 # TicTacToe C++ (SFML) - OOP Project
@@ -26,6 +47,47 @@ make
 ./tictactoe
 ```
 
+## Self-play
+`tictactoe_selfplay` plays engines against each other without a window, on all cores by default,
+and reports games/sec, results and per-move latency:
+```bash
+./tictactoe_selfplay --games 1000000 --x minimax --o random --seed 1 --threads 8
+```
+Engines are `minimax`, `minimax-search`, `mcts` and `random`; `--mcts-iterations` sets playouts per
+MCTS move. `minimax` answers from the precomputed solved table, so its latency is a lookup;
+`minimax-search` turns the table off and always searches.
+Each game's engines are seeded from `--seed` and the game number, so results repeat for any `--threads`.
+
+## Perft
+`tictactoe_perft` walks the whole game tree from a position (`x`, `o`, `.` row by row) and prints
+positions and results per depth plus nodes/sec; from the empty board it checks the known totals
+(255168 games, 131184 X wins) and exits non-zero on a mismatch:
+```bash
+./tictactoe_perft --threads 8
+./tictactoe_perft --position x...o.... --depth 4
+```
+`--check-parallel N` instead runs the AI's search at 1 and N threads, in each parallel mode, from
+every unfinished position (4520) and exits non-zero if any chosen move differs:
+```bash
+./tictactoe_perft --check-parallel 4
+```
+
+## Benchmarks
+`tictactoe_bench` times the Board and AI hot paths and prints JSON, one entry per benchmark
+with `name`, `ns_per_op`, `iterations` and `threads`, for tracking across commits. Entries named
+`*_excl_clear` time the search alone; the table clear before each one is left out:
+```bash
+./tictactoe_bench > bench.json
+```
+
+## Render benchmark
+`tictactoe_render_bench` renders a scripted sequence of games into an offscreen texture (no window,
+but it needs an OpenGL context, e.g. `xvfb-run`) and prints frames/sec and per-phase timings;
+`--png-dir` saves one PNG per scripted state for golden-image comparison:
+```bash
+xvfb-run ./tictactoe_render_bench --frames 10000 --png-dir out
+```
+
 ## Notes
 - The code is in a single-source file `src/main.cpp` for simplicity. You can split classes into headers/sources if desired.
 - Place a TTF font inside `assets/` and name it `font.ttf` (or change the path in the code).
@@ -36,120 +98,1558 @@ make
 #include <vector>
 #include <optional>
 #include <limits>
+#include <algorithm>
 #include <string>
 #include <iostream>
+#include <cstdint>
+#include <cstddef>
+#include <cstdlib>
+#include <cctype>
+#include <cstdio>
+#include <fstream>
+#include <tuple>
+#include <cstring>
+#include <cassert>
+#include <new>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <chrono>
+#include <memory>
+#include <cmath>
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <immintrin.h>
+#define TICTACTOE_SSE2 1
+#endif
+
+// Simple TicTacToe with OOP and SFML GUI
+// Classes: Board, AI, Game, GUI
+
+enum class Cell { Empty, X, O };
+
+#ifndef NDEBUG
+// debug builds count heap allocations per thread so hot paths can assert they make none
+inline thread_local std::uint64_t heapAllocations = 0;
+
+void* operator new(std::size_t n) {
+    ++heapAllocations;
+    if (void *p = std::malloc(n ? n : 1)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+#endif
+
+// Fixed-capacity list of (r,c) moves that lives on the stack
+template <int Capacity>
+class MoveList {
+public:
+    void push(int r, int c) { moves[count++] = {r, c}; }
+    int size() const { return count; }
+    bool empty() const { return count == 0; }
+    std::pair<int,int> const& operator[](int i) const { return moves[i]; }
+    std::pair<int,int> const* begin() const { return moves.data(); }
+    std::pair<int,int> const* end() const { return moves.data() + count; }
+
+private:
+    std::array<std::pair<int,int>, Capacity> moves;
+    int count = 0;
+};
+
+// Bit helpers for the 9-bit board masks (bit i == cell r*SIZE+c)
+inline int popCount(unsigned m) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcount(m);
+#else
+    int n = 0;
+    for (; m; m &= m - 1) ++n;
+    return n;
+#endif
+}
+
+inline int lowestBit(unsigned m) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctz(m);
+#else
+    int i = 0;
+    while (!(m & 1u)) { m >>= 1; ++i; }
+    return i;
+#endif
+}
+
+// splitmix64: seeds the engines' generators and spreads position codes into table keys
+constexpr std::uint64_t splitMix64(std::uint64_t &state) {
+    std::uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+// xorshift64* step for the engines' random moves; rng must not be zero
+inline std::uint64_t nextRandom(std::uint64_t &rng) {
+    rng ^= rng >> 12;
+    rng ^= rng << 25;
+    rng ^= rng >> 27;
+    return rng * 0x2545F4914F6CDD1Dull;
+}
+
+// D4 symmetries of an N x N board as cell permutations: perm[t][idx] is where
+// cell idx lands under transform t (4 rotations, then 4 reflections)
+template <int N>
+constexpr std::array<std::array<int, N*N>, 8> makeD4Permutations() {
+    std::array<std::array<int, N*N>, 8> perm{};
+    for (int r = 0; r < N; ++r) for (int c = 0; c < N; ++c) {
+        int idx = r * N + c, m = N - 1;
+        perm[0][idx] = r * N + c;
+        perm[1][idx] = c * N + (m - r);
+        perm[2][idx] = (m - r) * N + (m - c);
+        perm[3][idx] = (m - c) * N + r;
+        perm[4][idx] = r * N + (m - c);
+        perm[5][idx] = (m - r) * N + c;
+        perm[6][idx] = c * N + r;
+        perm[7][idx] = (m - c) * N + (m - r);
+    }
+    return perm;
+}
+
+// Win lines through each cell, so a move only has to test the lines it touches
+struct CellLines {
+    unsigned masks[4];
+    int count;
+};
+
+template <int Cells, int Lines>
+constexpr std::array<CellLines, Cells> makeCellLines(const unsigned (&wins)[Lines]) {
+    std::array<CellLines, Cells> table{};
+    for (int idx = 0; idx < Cells; ++idx)
+        for (unsigned w: wins)
+            if (w & (1u << idx)) table[idx].masks[table[idx].count++] = w;
+    return table;
+}
+
+// Outcome of Board::makeMove; Win means the player who just moved has won
+enum class MoveResult { Illegal, Ongoing, Win, Draw };
+
+// Board state as one 32-bit word (X mask in the low half, O mask in the high
+// half) and its outcome, for batched evaluation with Board::checkWinners
+struct PackedBoard {
+    std::uint32_t bits;
+};
+enum class Outcome : std::uint8_t { Ongoing, XWins, OWins, Draw };
+
+class Board {
+public:
+    static const int SIZE = 3;
+    static constexpr unsigned FULL = (1u << (SIZE*SIZE)) - 1;
+    // rows, cols, diagonals
+    static constexpr unsigned WIN_MASKS[8] = {
+        0007, 0070, 0700,
+        0111, 0222, 0444,
+        0421, 0124
+    };
+    // search order: centre, corners, edges
+    static constexpr int MOVE_ORDER[SIZE*SIZE] = { 4, 0, 2, 6, 8, 1, 3, 5, 7 };
+    static constexpr std::array<CellLines, SIZE*SIZE> CELL_LINES = makeCellLines<SIZE*SIZE>(WIN_MASKS);
+
+    static constexpr int SYMMETRY_COUNT = 8;
+    static constexpr std::array<std::array<int, SIZE*SIZE>, SYMMETRY_COUNT> SYMMETRIES = makeD4Permutations<SIZE>();
+
+    Board() {}
+
+    static Board fromBits(unsigned x, unsigned o) {
+        Board b;
+        for (unsigned m = x & FULL; m; m &= m - 1) b.place(lowestBit(m), Cell::X);
+        for (unsigned m = o & FULL & ~x; m; m &= m - 1) b.place(lowestBit(m), Cell::O);
+        return b;
+    }
+
+    // only lines through the new mark can have been completed, so the
+    // outcome costs 2-4 mask tests instead of a full checkWinner scan
+    MoveResult makeMove(int r, int c, Cell player) {
+        int idx = r * SIZE + c;
+        if ((xBits | oBits) & (1u << idx)) return MoveResult::Illegal;
+        place(idx, player);
+        unsigned mine = bits(player);
+        CellLines const &lines = CELL_LINES[idx];
+        for (int i = 0; i < lines.count; ++i)
+            if ((mine & lines.masks[i]) == lines.masks[i]) return MoveResult::Win;
+        return isFull() ? MoveResult::Draw : MoveResult::Ongoing;
+    }
+
+    void undoMove(int r, int c) {
+        int idx = r * SIZE + c;
+        unsigned bit = 1u << idx;
+        xBits &= ~bit;
+        oBits &= ~bit;
+    }
+
+    MoveList<SIZE*SIZE> availableMoves() const {
+        MoveList<SIZE*SIZE> moves;
+        for (unsigned m = emptyBits(); m; m &= m - 1) {
+            int idx = lowestBit(m);
+            moves.push(idx / SIZE, idx % SIZE);
+        }
+        return moves;
+    }
+
+    bool isFull() const { return (xBits | oBits) == FULL; }
+
+    std::optional<Cell> checkWinner() const {
+        for (unsigned w: WIN_MASKS) {
+            if ((xBits & w) == w) return Cell::X;
+            if ((oBits & w) == w) return Cell::O;
+        }
+        return std::nullopt;
+    }
+
+    // outcome of each of count boards, vectorized (AVX2: 8 boards per instruction,
+    // SSE2: 4) where the CPU allows; X is reported if both players have a line
+    static void checkWinners(PackedBoard const *boards, std::size_t count, Outcome *out);
+
+    PackedBoard packed() const { return {xBits | oBits << 16}; }
+
+    Cell get(int r, int c) const {
+        unsigned bit = 1u << (r * SIZE + c);
+        if (xBits & bit) return Cell::X;
+        if (oBits & bit) return Cell::O;
+        return Cell::Empty;
+    }
+
+    unsigned bits(Cell player) const { return player == Cell::X ? xBits : oBits; }
+    unsigned emptyBits() const { return ~(xBits | oBits) & FULL; }
+    int moveCount() const { return popCount(xBits | oBits); }
+
+    void reset() { xBits = oBits = 0; }
+
+private:
+    // one occupancy mask per player
+    unsigned xBits = 0;
+    unsigned oBits = 0;
+
+    void place(int idx, Cell player) {
+        if (player == Cell::X) xBits |= 1u << idx;
+        else oBits |= 1u << idx;
+    }
+};
+
+inline Outcome outcomeOf(PackedBoard b) {
+    unsigned x = b.bits & 0xFFFF, o = b.bits >> 16;
+    for (unsigned w: Board::WIN_MASKS) if ((x & w) == w) return Outcome::XWins;
+    for (unsigned w: Board::WIN_MASKS) if ((o & w) == w) return Outcome::OWins;
+    return (x | o) == Board::FULL ? Outcome::Draw : Outcome::Ongoing;
+}
+
+#ifdef TICTACTOE_SSE2
+// 4 boards per step; returns how many boards it handled
+inline std::size_t checkWinnersSse2(PackedBoard const *boards, std::size_t count, Outcome *out) {
+    const __m128i full = _mm_set1_epi32((int)Board::FULL);
+    std::size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<__m128i const*>(boards + i));
+        __m128i xWin = _mm_setzero_si128(), oWin = _mm_setzero_si128();
+        for (unsigned w: Board::WIN_MASKS) {
+            __m128i wx = _mm_set1_epi32((int)w), wo = _mm_set1_epi32((int)(w << 16));
+            xWin = _mm_or_si128(xWin, _mm_cmpeq_epi32(_mm_and_si128(v, wx), wx));
+            oWin = _mm_or_si128(oWin, _mm_cmpeq_epi32(_mm_and_si128(v, wo), wo));
+        }
+        __m128i isFull = _mm_cmpeq_epi32(_mm_and_si128(_mm_or_si128(v, _mm_srli_epi32(v, 16)), full), full);
+        // Draw (3) unless someone won; O (2) unless X won; X (1)
+        __m128i res = _mm_and_si128(isFull, _mm_set1_epi32(3));
+        res = _mm_or_si128(_mm_and_si128(oWin, _mm_set1_epi32(2)), _mm_andnot_si128(oWin, res));
+        res = _mm_or_si128(_mm_and_si128(xWin, _mm_set1_epi32(1)), _mm_andnot_si128(xWin, res));
+        // narrow 32-bit lanes to bytes
+        res = _mm_packs_epi32(res, res);
+        res = _mm_packus_epi16(res, res);
+        std::uint32_t bytes = (std::uint32_t)_mm_cvtsi128_si32(res);
+        std::memcpy(out + i, &bytes, 4);
+    }
+    return i;
+}
+#endif
+
+#if defined(TICTACTOE_SSE2) && (defined(__GNUC__) || defined(__clang__))
+// compiled for AVX2 regardless of -m flags; only called after a CPU check
+__attribute__((target("avx2")))
+inline std::size_t checkWinnersAvx2(PackedBoard const *boards, std::size_t count, Outcome *out) {
+    const __m256i full = _mm256_set1_epi32((int)Board::FULL);
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(boards + i));
+        __m256i xWin = _mm256_setzero_si256(), oWin = _mm256_setzero_si256();
+        for (unsigned w: Board::WIN_MASKS) {
+            __m256i wx = _mm256_set1_epi32((int)w), wo = _mm256_set1_epi32((int)(w << 16));
+            xWin = _mm256_or_si256(xWin, _mm256_cmpeq_epi32(_mm256_and_si256(v, wx), wx));
+            oWin = _mm256_or_si256(oWin, _mm256_cmpeq_epi32(_mm256_and_si256(v, wo), wo));
+        }
+        __m256i isFull = _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_or_si256(v, _mm256_srli_epi32(v, 16)), full), full);
+        __m256i res = _mm256_and_si256(isFull, _mm256_set1_epi32(3));
+        res = _mm256_blendv_epi8(res, _mm256_set1_epi32(2), oWin);
+        res = _mm256_blendv_epi8(res, _mm256_set1_epi32(1), xWin);
+        // narrow 32-bit lanes to bytes; packs work per 128-bit half, so fix the order after
+        res = _mm256_packs_epi32(res, res);
+        res = _mm256_packus_epi16(res, res);
+        std::uint32_t lo = (std::uint32_t)_mm256_extract_epi32(res, 0);
+        std::uint32_t hi = (std::uint32_t)_mm256_extract_epi32(res, 4);
+        std::memcpy(out + i, &lo, 4);
+        std::memcpy(out + i + 4, &hi, 4);
+    }
+    return i;
+}
+
+inline bool cpuHasAvx2() {
+    static const bool has = __builtin_cpu_supports("avx2");
+    return has;
+}
+#endif
+
+inline void Board::checkWinners(PackedBoard const *boards, std::size_t count, Outcome *out) {
+    std::size_t done = 0;
+#if defined(TICTACTOE_SSE2) && (defined(__GNUC__) || defined(__clang__))
+    if (cpuHasAvx2()) done = checkWinnersAvx2(boards, count, out);
+#endif
+#ifdef TICTACTOE_SSE2
+    done += checkWinnersSse2(boards + done, count - done, out + done);
+#endif
+    for (std::size_t i = done; i < count; ++i) out[i] = outcomeOf(boards[i]);
+}
+
+// table[t][mask]: the cell mask under symmetry t, for every mask
+constexpr std::array<std::array<std::uint16_t, Board::FULL + 1>, Board::SYMMETRY_COUNT> makeMaskTransforms() {
+    std::array<std::array<std::uint16_t, Board::FULL + 1>, Board::SYMMETRY_COUNT> table{};
+    for (int t = 0; t < Board::SYMMETRY_COUNT; ++t)
+        for (unsigned mask = 0; mask <= Board::FULL; ++mask) {
+            unsigned out = 0;
+            for (int idx = 0; idx < Board::SIZE*Board::SIZE; ++idx)
+                if (mask & (1u << idx)) out |= 1u << Board::SYMMETRIES[t][idx];
+            table[t][mask] = (std::uint16_t)out;
+        }
+    return table;
+}
+
+// Canonical forms of positions under the board's D4 symmetries. Computed from the
+// masks when asked, so only the search pays for them, not every makeMove.
+struct Symmetry {
+    static constexpr std::array<std::array<std::uint16_t, Board::FULL + 1>, Board::SYMMETRY_COUNT> TRANSFORMED = makeMaskTransforms();
+
+    static unsigned transform(unsigned mask, int t) { return TRANSFORMED[t][mask]; }
+
+    // smallest (x << 9 | o) over the 8 transforms: equal exactly for positions in the same class
+    static std::uint32_t canonicalCode(Board const &board) {
+        unsigned x = board.bits(Cell::X), o = board.bits(Cell::O);
+        std::uint32_t best = x << (Board::SIZE*Board::SIZE) | o;
+        for (int t = 1; t < Board::SYMMETRY_COUNT; ++t)
+            best = std::min<std::uint32_t>(best, transform(x, t) << (Board::SIZE*Board::SIZE) | transform(o, t));
+        return best;
+    }
+
+    // canonicalCode spread over 64 bits for table indexing
+    static std::uint64_t canonicalKey(Board const &board) {
+        std::uint64_t state = canonicalCode(board);
+        return splitMix64(state);
+    }
+};
+
+// Fixed-size, always-replace transposition table keyed by 64-bit position keys
+class TranspositionTable {
+public:
+    enum class Bound : std::uint8_t { None, Exact, Lower, Upper };
+
+    struct Entry {
+        std::uint64_t key = 0;
+        std::int16_t score = 0;
+        std::int8_t depth = 0;
+        Bound bound = Bound::None;
+    };
+
+    explicit TranspositionTable(std::size_t megabytes = 1) { resize(megabytes); }
+
+    void resize(std::size_t megabytes) {
+        std::size_t count = 1;
+        std::size_t limit = std::max<std::size_t>(megabytes * 1024 * 1024 / sizeof(Entry), 1);
+        while (count * 2 <= limit) count *= 2;
+        entries.assign(count, Entry{});
+        mask = count - 1;
+    }
+
+    void clear() { std::fill(entries.begin(), entries.end(), Entry{}); }
+
+    // returns nullptr on miss
+    const Entry* probe(std::uint64_t key) const {
+        const Entry &e = entries[key & mask];
+        return (e.bound != Bound::None && e.key == key) ? &e : nullptr;
+    }
+
+    void store(std::uint64_t key, int score, int depth, Bound bound) {
+        Entry &e = entries[key & mask];
+        e.key = key;
+        e.score = (std::int16_t)score;
+        e.depth = (std::int8_t)depth;
+        e.bound = bound;
+    }
+
+    std::size_t capacity() const { return entries.size(); }
+    std::size_t megabytes() const { return std::max<std::size_t>(entries.size() * sizeof(Entry) / (1024 * 1024), 1); }
+
+private:
+    std::vector<Entry> entries;
+    std::size_t mask = 0;
+};
+
+// Perfect play for every position reachable with X moving first, solved at compile
+// time and indexed by the base-3 encoding of the board (empty=0, X=1, O=2 per cell)
+class SolvedTable {
+public:
+    static constexpr int CELLS = Board::SIZE*Board::SIZE;
+    static constexpr int SLOTS = 19683; // 3^9
+    static constexpr int NO_MOVE = 0x0F;
+
+    constexpr SolvedTable(): entries{}, ternary{}, wins{} {
+        for (unsigned m = 0; m <= Board::FULL; ++m) {
+            int t = 0, p = 1;
+            for (int i = 0; i < CELLS; ++i, p *= 3) if (m & (1u << i)) t += p;
+            ternary[m] = t;
+            for (unsigned w: Board::WIN_MASKS) if ((m & w) == w) wins[m] = true;
+        }
+        solve(0, 0, true);
+    }
+
+    constexpr int index(unsigned x, unsigned o) const { return ternary[x] + 2 * ternary[o]; }
+    constexpr bool contains(int idx) const { return entries[idx] != 0; }
+    // cell index of the best move for the side to move, or NO_MOVE on terminal positions
+    constexpr int bestMove(int idx) const { return entries[idx] & 0x0F; }
+    // -1 loss, 0 draw, 1 win for the side to move
+    constexpr int score(int idx) const { return (entries[idx] >> 4) - 2; }
+
+private:
+    // (score + 2) << 4 | move; 0 marks an unreachable slot
+    std::array<std::uint8_t, SLOTS> entries;
+    std::array<int, Board::FULL + 1> ternary;
+    std::array<bool, Board::FULL + 1> wins;
+
+    constexpr int solve(unsigned x, unsigned o, bool xToMove) {
+        int idx = index(x, o);
+        if (entries[idx]) return score(idx);
+        int best = -2, move = NO_MOVE;
+        if (wins[xToMove ? o : x]) best = -1;
+        else if ((x | o) == Board::FULL) best = 0;
+        else {
+            for (int cell: Board::MOVE_ORDER) {
+                unsigned bit = 1u << cell;
+                if ((x | o) & bit) continue;
+                int s = xToMove ? -solve(x | bit, o, false) : -solve(x, o | bit, true);
+                if (s > best) { best = s; move = cell; }
+            }
+        }
+        entries[idx] = (std::uint8_t)(((best + 2) << 4) | move);
+        return best;
+    }
+};
+
+// Lock-free table shared by all Lazy SMP threads. Each slot is two independent
+// 64-bit atomics, the packed entry and key ^ entry; a torn read (one word from
+// another thread's write) fails the XOR check and is treated as a miss
+class SharedTranspositionTable {
+public:
+    explicit SharedTranspositionTable(std::size_t megabytes = 1) { resize(megabytes); }
+
+    void resize(std::size_t megabytes) {
+        std::size_t count = 1;
+        std::size_t limit = std::max<std::size_t>(megabytes * 1024 * 1024 / sizeof(Slot), 1);
+        while (count * 2 <= limit) count *= 2;
+        slots = std::make_unique<Slot[]>(count);
+        mask = count - 1;
+    }
+
+    void clear() {
+        for (std::size_t i = 0; i <= mask; ++i) {
+            slots[i].check.store(0, std::memory_order_relaxed);
+            slots[i].data.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    std::optional<TranspositionTable::Entry> probe(std::uint64_t key) const {
+        Slot const &slot = slots[key & mask];
+        std::uint64_t data = slot.data.load(std::memory_order_relaxed);
+        std::uint64_t check = slot.check.load(std::memory_order_relaxed);
+        if ((check ^ data) != key) return std::nullopt;
+        TranspositionTable::Entry e;
+        e.key = key;
+        e.score = (std::int16_t)(data & 0xFFFF);
+        e.depth = (std::int8_t)((data >> 16) & 0xFF);
+        e.bound = (TranspositionTable::Bound)((data >> 24) & 0xFF);
+        if (e.bound == TranspositionTable::Bound::None) return std::nullopt;
+        return e;
+    }
+
+    void store(std::uint64_t key, int score, int depth, TranspositionTable::Bound bound) {
+        std::uint64_t data = (std::uint64_t)(std::uint16_t)score
+                           | (std::uint64_t)(std::uint8_t)depth << 16
+                           | (std::uint64_t)bound << 24;
+        Slot &slot = slots[key & mask];
+        slot.data.store(data, std::memory_order_relaxed);
+        slot.check.store(key ^ data, std::memory_order_relaxed);
+    }
+
+private:
+    struct Slot {
+        std::atomic<std::uint64_t> check{0};
+        std::atomic<std::uint64_t> data{0};
+    };
+
+    std::unique_ptr<Slot[]> slots;
+    std::size_t mask = 0;
+};
+
+inline constexpr SolvedTable SOLVED_TABLE{};
+static_assert(SOLVED_TABLE.score(0) == 0, "3x3 tic-tac-toe is a draw under perfect play");
+
+inline Cell opponent(Cell player) { return player == Cell::X ? Cell::O : Cell::X; }
+
+// Fixed set of threads for fork-join jobs: run(job) calls job(i) for every
+// i in [0, size()), with the calling thread taking i == 0, and returns when
+// all of them have finished
+class ThreadPool {
+public:
+    explicit ThreadPool(int threads) {
+        for (int i = 1; i < threads; ++i) workers.emplace_back([this, i]{ loop(i); });
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            quit = true;
+        }
+        wake.notify_all();
+        for (auto &t: workers) t.join();
+    }
+
+    ThreadPool(ThreadPool const&) = delete;
+    ThreadPool& operator=(ThreadPool const&) = delete;
+
+    int size() const { return (int)workers.size() + 1; }
+
+    template <class Job>
+    void run(Job &job) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            // type-erased without std::function so dispatch never allocates
+            task = [](void *ctx, int i) { (*static_cast<Job*>(ctx))(i); };
+            taskCtx = &job;
+            busy = (int)workers.size();
+            ++round;
+        }
+        wake.notify_all();
+        job(0);
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [this]{ return busy == 0; });
+    }
+
+private:
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake, done;
+    void (*task)(void*, int) = nullptr;
+    void *taskCtx = nullptr;
+    std::uint64_t round = 0;
+    int busy = 0;
+    bool quit = false;
+
+    void loop(int index) {
+        std::uint64_t seen = 0;
+        for (;;) {
+            void (*fn)(void*, int);
+            void *ctx;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [&]{ return quit || round != seen; });
+                if (quit) return;
+                seen = round;
+                fn = task;
+                ctx = taskCtx;
+            }
+            fn(ctx, index);
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--busy == 0) done.notify_one();
+        }
+    }
+};
+
+// Fixed-capacity deque for work stealing: the owner pushes and pops at the
+// back, thieves take from the front
+template <class T, int Capacity>
+class StealQueue {
+public:
+    bool push(T const &item) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (tail - head == Capacity) return false;
+        items[tail++ % Capacity] = item;
+        return true;
+    }
+
+    bool pop(T &item) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (tail == head) return false;
+        item = items[--tail % Capacity];
+        return true;
+    }
+
+    bool steal(T &item) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (tail == head) return false;
+        item = items[head++ % Capacity];
+        return true;
+    }
+
+private:
+    std::mutex mutex;
+    std::array<T, Capacity> items;
+    std::uint64_t head = 0, tail = 0;
+};
+
+// What one findBestMove did; engines fill in the counters that apply to them
+struct SearchStats {
+    std::uint64_t nodes = 0;
+    std::uint64_t terminalNodes = 0; // wins and draws reached
+    std::uint64_t ttHits = 0;        // table entries that were usable at their depth
+    std::uint64_t cutoffs = 0;       // beta cutoffs in the move loop
+    int maxDepth = 0;                // deepest ply below the root visited
+    double seconds = 0;
+
+    double nodesPerSecond() const { return seconds > 0 ? nodes / seconds : 0.0; }
+
+    void merge(SearchStats const &other) {
+        nodes += other.nodes;
+        terminalNodes += other.terminalNodes;
+        ttHits += other.ttHits;
+        cutoffs += other.cutoffs;
+        maxDepth = std::max(maxDepth, other.maxDepth);
+    }
+};
+
+inline std::ostream& operator<<(std::ostream &os, SearchStats const &s) {
+    return os << "nodes=" << s.nodes << " terminal=" << s.terminalNodes << " tt_hits=" << s.ttHits
+              << " cutoffs=" << s.cutoffs << " max_depth=" << s.maxDepth << " seconds=" << s.seconds
+              << " nodes_per_sec=" << s.nodesPerSecond();
+}
+
+// Common interface of the move-choosing engines, so Game and SearchWorker
+// do not care which one they drive
+class SearchEngine {
+public:
+    virtual ~SearchEngine() = default;
+
+    // returns best move (r,c) for the engine's player
+    virtual std::pair<int,int> findBestMove(Board board) = 0;
+
+    // counters of the last findBestMove; only read it from the thread that searched
+    virtual SearchStats lastStats() const { return {}; }
+
+    // restarts the engine's random choices from seed; deterministic engines ignore it
+    virtual void setSeed(std::uint64_t) {}
+
+    // safe to call from any thread; a stopped search returns early with an
+    // unspecified move
+    void requestStop() { stopRequested.store(true, std::memory_order_relaxed); }
+    void clearStop() { stopRequested.store(false, std::memory_order_relaxed); }
+    bool stopped() const { return stopRequested.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<bool> stopRequested{false};
+};
+
+// Negamax alpha-beta AI for TicTacToe
+class AI : public SearchEngine {
+public:
+    AI(Cell aiPlayer, Cell humanPlayer, std::size_t ttMegabytes = 1): ai(aiPlayer), human(humanPlayer), table(ttMegabytes) {}
+
+    // the tables are kept across calls; positions solved once stay solved
+    void setTableSize(std::size_t megabytes) {
+        table.resize(megabytes);
+        for (auto &t: helperTables) t.resize(megabytes);
+        if (sharedTable) sharedTable->resize(megabytes);
+    }
+    void clearTable() {
+        table.clear();
+        for (auto &t: helperTables) t.clear();
+        if (sharedTable) sharedTable->clear();
+    }
+
+    // positions from normal play are a single table lookup
+    std::pair<int,int> findBestMove(Board board) override {
+        if (useSolvedTable && ai == (board.moveCount() % 2 == 0 ? Cell::X : Cell::O)) {
+            auto start = Clock::now();
+            int idx = SOLVED_TABLE.index(board.bits(Cell::X), board.bits(Cell::O));
+            if (SOLVED_TABLE.contains(idx) && SOLVED_TABLE.bestMove(idx) != SolvedTable::NO_MOVE) {
+                int cell = SOLVED_TABLE.bestMove(idx);
+                stats = {};
+                stats.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+                return {cell / Board::SIZE, cell % Board::SIZE};
+            }
+        }
+        return search(board);
+    }
+
+    SearchStats lastStats() const override { return stats; }
+
+    // lookups are on by default; disable to always run the tree search
+    void setUseSolvedTable(bool enabled) { useSolvedTable = enabled; }
+
+    // RootSplit hands whole root moves to threads; YoungBrothersWait searches the
+    // root serially and, below it, farms out the siblings of every node whose
+    // eldest child has been searched; LazySmp has every thread search the whole
+    // root with its own move order, cooperating only through one shared table
+    enum class Parallelism { RootSplit, YoungBrothersWait, LazySmp };
+
+    // search with this many threads (1 = search on the caller only); each helper
+    // thread gets its own table, sized like the main one, except under LazySmp
+    void setThreads(int threads) {
+        threads = std::clamp(threads, 1, MAX_THREADS);
+        pool = threads > 1 ? std::make_unique<ThreadPool>(threads) : nullptr;
+        queues = threads > 1 ? std::make_unique<TaskQueue[]>(threads) : nullptr;
+        updateHelperTables();
+    }
+    int threadCount() const { return pool ? pool->size() : 1; }
+
+    void setParallelism(Parallelism mode) {
+        parallelism = mode;
+        if (mode == Parallelism::LazySmp && !sharedTable)
+            sharedTable = std::make_unique<SharedTranspositionTable>(table.megabytes());
+        updateHelperTables();
+    }
+
+    // iterative-deepening negamax from the given position, ignoring the solved table;
+    // with a time budget set, returns the best move of the deepest completed iteration
+    std::pair<int,int> search(Board board) {
+#ifndef NDEBUG
+        std::uint64_t allocationsBefore = heapAllocations;
+        poolAllocations = 0;
+#endif
+        auto start = Clock::now();
+        stats = {};
+        depthReached = 0;
+        timeUp = false;
+        deadline = timeBudget == Clock::duration::zero() ? Clock::time_point::max() : Clock::now() + timeBudget;
+
+        // root moves leading to symmetric positions score the same; keep the
+        // first of each in static order, which is also the tie-break rank
+        RootMoves root;
+        std::uint64_t seen[Board::SIZE*Board::SIZE];
+        for (int idx: Board::MOVE_ORDER) {
+            if (!(board.emptyBits() & (1u << idx))) continue;
+            int r = idx / Board::SIZE, c = idx % Board::SIZE;
+            board.makeMove(r, c, ai);
+            std::uint64_t child = Symmetry::canonicalCode(board);
+            board.undoMove(r, c);
+            if (std::find(seen, seen + root.count, child) != seen + root.count) continue;
+            seen[root.count] = child;
+            root.cells[root.count++] = idx;
+        }
+
+        // any legal move is a valid answer until the first iteration completes
+        int bestRank = 0;
+        std::pair<int,int> bestMove = {-1,-1};
+        if (root.count) bestMove = {root.cells[0] / Board::SIZE, root.cells[0] % Board::SIZE};
+
+        int maxDepth = Board::SIZE*Board::SIZE - board.moveCount();
+        for (int depth = 1; depth <= maxDepth && root.count; ++depth) {
+            int rank = bestRank, score = 0;
+            if (!searchRoot(board, root, depth, rank, score)) break;
+            bestRank = rank;
+            bestMove = {root.cells[rank] / Board::SIZE, root.cells[rank] % Board::SIZE};
+            depthReached = depth;
+            if (score >= WIN || score <= -WIN) break; // proven result, deeper search cannot change it
+        }
+        stats.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        if (logStats) std::clog << "search " << stats << "\n";
+#ifndef NDEBUG
+        searchAllocations = heapAllocations - allocationsBefore + poolAllocations;
+        assert(searchAllocations == 0 && "search hot path must not allocate");
+#endif
+        return bestMove;
+    }
+
+    // wall-clock limit per search; zero (the default) searches to the end of the game
+    void setTimeBudget(std::chrono::milliseconds budget) {
+        timeBudget = std::max(Clock::duration(budget), Clock::duration::zero());
+    }
+
+    // depth of the deepest completed iteration of the last search
+    int lastDepth() const { return depthReached; }
+
+    // nodes visited by the last findBestMove (0 when it was answered by lookup)
+    std::uint64_t lastNodeCount() const { return stats.nodes; }
+
+    // prints the stats of every tree search to std::clog
+    void setLogStats(bool enabled) { logStats = enabled; }
+
+#ifndef NDEBUG
+    // heap allocations made during the last search, over all its threads; always 0
+    std::uint64_t lastSearchAllocations() const { return searchAllocations; }
+#endif
+
+    // nodes the plain minimax (no pruning, no table) visits below the root, for comparison
+    static std::uint64_t minimaxNodeCount(Board board, Cell toMove) {
+        std::uint64_t count = 0;
+        for (auto m: board.availableMoves()) {
+            MoveResult result = board.makeMove(m.first, m.second, toMove);
+            count += 1;
+            if (result == MoveResult::Ongoing) count += fullTreeNodes(board, opponent(toMove));
+            board.undoMove(m.first, m.second);
+        }
+        return count;
+    }
+
+private:
+    // unique root moves in static order
+    struct RootMoves {
+        int cells[Board::SIZE*Board::SIZE];
+        int count = 0;
+    };
+
+    // a node whose younger siblings are being searched by other threads; lives
+    // on the owner's stack until every task referring to it has finished
+    struct SplitPoint {
+        Board board;
+        Cell toMove;
+        int depth;
+        int beta;
+        std::atomic<int> alpha;
+        std::atomic<int> best;
+        std::atomic<int> pending;
+        std::atomic<bool> cutoff{false};
+        SplitPoint *parent;
+    };
+
+    // one sibling move of a split point
+    struct Task {
+        SplitPoint *split;
+        int cell;
+    };
+
+    using TaskQueue = StealQueue<Task, 64>;
+
+    // state owned by one searching thread
+    struct SearchThread {
+        TranspositionTable *table;
+        int index;
+        SearchStats stats;
+        // depth of the iteration being searched, for turning remaining depth into ply
+        int rootDepth = 0;
+        // innermost split point this thread is working under
+        SplitPoint *split = nullptr;
+        // set under LazySmp; replaces table
+        SharedTranspositionTable *shared = nullptr;
+        // Lazy SMP helper: its results are only the entries it leaves behind
+        bool helper = false;
+    };
+
+    Cell ai, human;
+    TranspositionTable table;
+    std::vector<TranspositionTable> helperTables;
+    std::unique_ptr<ThreadPool> pool;
+    std::unique_ptr<TaskQueue[]> queues;
+    std::unique_ptr<SharedTranspositionTable> sharedTable;
+    Parallelism parallelism = Parallelism::RootSplit;
+    std::atomic<bool> searchDone{false};
+    SearchStats stats;
+    bool logStats = false;
+    bool useSolvedTable = true;
+    using Clock = std::chrono::steady_clock;
+    Clock::duration timeBudget = Clock::duration::zero();
+    Clock::time_point deadline;
+    // shared so a split point's owner sees a timeout noticed by any helper
+    std::atomic<bool> timeUp{false};
+    int depthReached = 0;
+#ifndef NDEBUG
+    std::uint64_t searchAllocations = 0;
+    // added to by the pool threads, whose heapAllocations the caller cannot see
+    std::atomic<std::uint64_t> poolAllocations{0};
+#endif
+    static constexpr int MAX_THREADS = 256;
+    // nodes with fewer plies left are not worth handing to another thread
+    static constexpr int MIN_SPLIT_DEPTH = 3;
+    static constexpr int INF = 1000;
+    // above any heuristic score: evaluate() stays within +-3 per line
+    static constexpr int WIN = 100;
+    // deadline is checked once every this many nodes
+    static constexpr std::uint64_t TIME_CHECK_MASK = 1023;
+    // mixed into the key so the same cells with a different side to move never collide
+    static constexpr std::uint64_t SIDE_KEY = 0xD1B54A32D192ED03ull;
+
+    static std::uint64_t fullTreeNodes(Board &board, Cell toMove) {
+        std::uint64_t count = 0;
+        for (auto m: board.availableMoves()) {
+            MoveResult result = board.makeMove(m.first, m.second, toMove);
+            count += 1;
+            if (result == MoveResult::Ongoing) count += fullTreeNodes(board, opponent(toMove));
+            board.undoMove(m.first, m.second);
+        }
+        return count;
+    }
+
+    bool aborted(SearchThread const &st) const {
+        if (timeUp.load(std::memory_order_relaxed) || stopped()) return true;
+        if (st.helper && searchDone.load(std::memory_order_relaxed)) return true;
+        for (SplitPoint const *sp = st.split; sp; sp = sp->parent)
+            if (sp->cutoff.load(std::memory_order_relaxed)) return true;
+        return false;
+    }
+
+    // one table per helper thread, none under LazySmp where every thread uses sharedTable
+    void updateHelperTables() {
+        std::size_t wanted = parallelism == Parallelism::LazySmp ? 0 : threadCount() - 1;
+        if (helperTables.size() == wanted) return;
+        helperTables.clear();
+        for (std::size_t i = 0; i < wanted; ++i) helperTables.emplace_back(table.megabytes());
+    }
+
+    SearchThread makeThread(int thread) {
+        bool shared = pool && parallelism == Parallelism::LazySmp;
+        SearchThread st{thread == 0 || shared ? &table : &helperTables[thread - 1], thread, {}};
+        if (shared) st.shared = sharedTable.get();
+        return st;
+    }
+
+    std::optional<TranspositionTable::Entry> probe(SearchThread const &st, std::uint64_t key) const {
+        if (st.shared) return st.shared->probe(key);
+        if (auto e = st.table->probe(key)) return *e;
+        return std::nullopt;
+    }
+
+    void store(SearchThread &st, std::uint64_t key, int score, int depth, TranspositionTable::Bound bound) {
+        if (st.shared) st.shared->store(key, score, depth, bound);
+        else st.table->store(key, score, depth, bound);
+    }
+
+    bool takeTask(SearchThread const &st, Task &task) {
+        if (queues[st.index].pop(task)) return true;
+        int n = threadCount();
+        for (int i = 1; i < n; ++i)
+            if (queues[(st.index + i) % n].steal(task)) return true;
+        return false;
+    }
+
+    void runTask(SearchThread &st, Task task) {
+        SplitPoint &sp = *task.split;
+        SplitPoint *saved = st.split;
+        st.split = &sp;
+        if (!aborted(st)) {
+            Board local = sp.board;
+            int r = task.cell / Board::SIZE, c = task.cell % Board::SIZE;
+            int alpha = sp.alpha.load();
+            MoveResult result = local.makeMove(r, c, sp.toMove);
+            int score = pvSearch(st, local, result, opponent(sp.toMove), sp.depth - 1, alpha, sp.beta, false);
+            if (!aborted(st)) {
+                for (int b = sp.best.load(); score > b && !sp.best.compare_exchange_weak(b, score);) {}
+                for (int a = sp.alpha.load(); score > a && !sp.alpha.compare_exchange_weak(a, score);) {}
+                if (score >= sp.beta) { sp.cutoff = true; ++st.stats.cutoffs; }
+            }
+        }
+        st.split = saved;
+        // the owner may return as soon as this reaches zero; sp is gone after it
+        sp.pending.fetch_sub(1);
+    }
+
+    // Young Brothers Wait: search the given younger siblings on whichever threads
+    // are idle, helping with queued work until all of them are done
+    int searchSiblings(SearchThread &st, Board const &board, Cell toMove, int depth, int alpha, int beta,
+                       int const *cells, int count) {
+        SplitPoint sp;
+        sp.board = board;
+        sp.toMove = toMove;
+        sp.depth = depth;
+        sp.beta = beta;
+        sp.alpha = alpha;
+        sp.best = -INF;
+        sp.pending = count;
+        sp.parent = st.split;
+        for (int i = 0; i < count; ++i) {
+            Task task{&sp, cells[i]};
+            if (!queues[st.index].push(task)) runTask(st, task);
+        }
+        while (sp.pending.load() > 0) {
+            Task task;
+            if (takeTask(st, task)) runTask(st, task);
+            else std::this_thread::yield();
+        }
+        return sp.best.load();
+    }
+
+    // what pool threads other than the root searcher do under YoungBrothersWait
+    void helpUntilDone(SearchThread &st) {
+        while (!searchDone.load()) {
+            Task task;
+            if (takeTask(st, task)) runTask(st, task);
+            else std::this_thread::yield();
+        }
+    }
+
+    // pool->run; debug builds also count the allocations each pool thread makes.
+    // Thread 0 runs on the caller, whose count search() already takes.
+    template <class Job>
+    void runOnPool(Job &job) {
+#ifndef NDEBUG
+        auto counted = [&](int thread) {
+            std::uint64_t before = heapAllocations;
+            job(thread);
+            if (thread != 0) poolAllocations += heapAllocations - before;
+        };
+        pool->run(counted);
+#else
+        pool->run(job);
+#endif
+    }
+
+    // One iteration at the root; returns false if it was cut short. rank holds the
+    // previous best on entry (searched first) and the new best on return.
+    // Each root move is searched with alpha just below the best score found so far,
+    // so every move that ties the final best gets an exact score and the lowest rank
+    // wins. The chosen move therefore does not depend on which thread finished first.
+    bool searchRoot(Board const &board, RootMoves const &root, int depth, int &rank, int &bestScore) {
+        int order[Board::SIZE*Board::SIZE];
+        int count = 0;
+        order[count++] = rank;
+        for (int i = 0; i < root.count; ++i) if (i != rank) order[count++] = i;
+
+        int scores[Board::SIZE*Board::SIZE];
+        bool exact[Board::SIZE*Board::SIZE] = {};
+        SearchStats threadStats[MAX_THREADS];
+        std::atomic<int> next{0};
+        std::atomic<int> sharedAlpha{-INF};
+        std::atomic<bool> cut{false};
+
+        auto work = [&](int thread) {
+            SearchThread st = makeThread(thread);
+            st.rootDepth = depth;
+            Board local = board;
+            for (int i; (i = next.fetch_add(1)) < count;) {
+                int cell = root.cells[order[i]];
+                int r = cell / Board::SIZE, c = cell % Board::SIZE;
+                int floor = sharedAlpha.load();
+                bool full = floor == -INF;
+                int alpha = full ? -INF : floor - 1;
+                MoveResult result = local.makeMove(r, c, ai);
+                int score = pvSearch(st, local, result, human, depth - 1, alpha, INF, full);
+                local.undoMove(r, c);
+                if (aborted(st)) { cut = true; break; }
+                scores[order[i]] = score;
+                exact[order[i]] = full || score > alpha;
+                // raise the shared bound so other threads prune against it
+                for (int a = sharedAlpha.load(); score > a && !sharedAlpha.compare_exchange_weak(a, score);) {}
+            }
+            threadStats[thread] = st.stats;
+        };
+        auto youngBrothers = [&](int thread) {
+            if (thread == 0) {
+                work(0);
+                searchDone = true;
+            } else {
+                SearchThread st = makeThread(thread);
+                st.rootDepth = depth;
+                helpUntilDone(st);
+                threadStats[thread] = st.stats;
+            }
+        };
+        // helpers start at a different root move and odd ones search one ply
+        // deeper, so they fill the shared table with entries the main thread
+        // needs next rather than duplicating its work
+        auto lazySmp = [&](int thread) {
+            if (thread == 0) {
+                work(0);
+                searchDone = true;
+                return;
+            }
+            SearchThread st = makeThread(thread);
+            st.helper = true;
+            int helperDepth = std::min(depth + (thread & 1), Board::SIZE*Board::SIZE - board.moveCount());
+            st.rootDepth = helperDepth;
+            Board local = board;
+            for (int k = 0; k < count && !aborted(st); ++k) {
+                int cell = root.cells[order[(k + thread) % count]];
+                int r = cell / Board::SIZE, c = cell % Board::SIZE;
+                MoveResult result = local.makeMove(r, c, ai);
+                pvSearch(st, local, result, human, helperDepth - 1, -INF, INF, true);
+                local.undoMove(r, c);
+            }
+            threadStats[thread] = st.stats;
+        };
+        searchDone = false;
+        if (pool && parallelism == Parallelism::YoungBrothersWait) runOnPool(youngBrothers);
+        else if (pool && parallelism == Parallelism::LazySmp) runOnPool(lazySmp);
+        else if (pool) runOnPool(work);
+        else work(0);
+        for (int t = 0; t < threadCount(); ++t) stats.merge(threadStats[t]);
+        if (cut) return false;
+
+        int best = -1;
+        for (int i = 0; i < root.count; ++i) {
+            if (exact[i] && (best < 0 || scores[i] > scores[best])) best = i;
+        }
+        rank = best;
+        bestScore = scores[best];
+        return true;
+    }
+
+    // score, for the player who just moved, of the child reached by that move; the
+    // first child gets a full window, later ones a null window and a re-search if
+    // they land inside (alpha, beta)
+    int pvSearch(SearchThread &st, Board &board, MoveResult result, Cell toMove, int depth, int alpha, int beta, bool first) {
+        if (result != MoveResult::Ongoing) {
+            ++st.stats.nodes;
+            ++st.stats.terminalNodes;
+            st.stats.maxDepth = std::max(st.stats.maxDepth, st.rootDepth - depth);
+            return result == MoveResult::Win ? WIN : 0;
+        }
+        if (first) return -negamax(st, board, toMove, depth, -beta, -alpha);
+        int score = -negamax(st, board, toMove, depth, -alpha - 1, -alpha);
+        if (score > alpha && score < beta) score = -negamax(st, board, toMove, depth, -beta, -alpha);
+        return score;
+    }
+
+    // static score at the depth horizon: lines still open to one side only,
+    // weighted by how many of that side's marks they already hold
+    static int evaluate(Board const &board, Cell toMove) {
+        static constexpr int LINE_WEIGHT[4] = { 0, 1, 3, 0 };
+        unsigned mine = board.bits(toMove), theirs = board.bits(opponent(toMove));
+        int score = 0;
+        for (unsigned w: Board::WIN_MASKS) {
+            if (!(theirs & w)) score += LINE_WEIGHT[popCount(mine & w)];
+            else if (!(mine & w)) score -= LINE_WEIGHT[popCount(theirs & w)];
+        }
+        return score;
+    }
+
+    // score of a non-terminal position from the point of view of toMove
+    int negamax(SearchThread &st, Board &board, Cell toMove, int depth, int alpha, int beta) {
+        ++st.stats.nodes;
+        st.stats.maxDepth = std::max(st.stats.maxDepth, st.rootDepth - depth);
+        if ((st.stats.nodes & TIME_CHECK_MASK) == 0 && Clock::now() >= deadline) timeUp = true;
+        if (aborted(st)) return 0;
+        if (depth == 0) return evaluate(board, toMove);
+
+        std::uint64_t key = Symmetry::canonicalKey(board) ^ (toMove == Cell::O ? SIDE_KEY : 0);
+        int alphaOrig = alpha;
+        // only same-depth entries: a deeper result would make the score depend on what
+        // this thread's table happens to hold, and threaded root results must match
+        // the single-threaded ones; full-depth entries always have depth == empty cells
+        if (auto e = probe(st, key); e && e->depth == depth) {
+            ++st.stats.ttHits;
+            if (e->bound == TranspositionTable::Bound::Exact) return e->score;
+            if (e->bound == TranspositionTable::Bound::Lower) alpha = std::max(alpha, (int)e->score);
+            else if (e->bound == TranspositionTable::Bound::Upper) beta = std::min(beta, (int)e->score);
+            if (alpha >= beta) return e->score;
+        }
+
+        int cells[Board::SIZE*Board::SIZE];
+        int count = 0;
+        unsigned empty = board.emptyBits();
+        for (int idx: Board::MOVE_ORDER) if (empty & (1u << idx)) cells[count++] = idx;
+        // Lazy SMP helpers diverge from the main thread by swapping the first two moves at alternate depths
+        if (st.helper && count > 1 && ((st.index + depth) & 1)) std::swap(cells[0], cells[1]);
+        bool split = queues && parallelism == Parallelism::YoungBrothersWait && depth >= MIN_SPLIT_DEPTH;
+
+        int best = -INF;
+        for (int i = 0; i < count; ++i) {
+            // the eldest brother is always searched here first
+            if (i > 0 && split && count - i > 1) {
+                best = std::max(best, searchSiblings(st, board, toMove, depth, alpha, beta, cells + i, count - i));
+                break;
+            }
+            int r = cells[i] / Board::SIZE, c = cells[i] % Board::SIZE;
+            MoveResult result = board.makeMove(r, c, toMove);
+            int score = pvSearch(st, board, result, opponent(toMove), depth - 1, alpha, beta, i == 0);
+            board.undoMove(r, c);
+            best = std::max(best, score);
+            alpha = std::max(alpha, score);
+            if (alpha >= beta) { ++st.stats.cutoffs; break; }
+        }
+        // partial results must not reach the table
+        if (aborted(st)) return best;
+
+        TranspositionTable::Bound bound = TranspositionTable::Bound::Exact;
+        if (best <= alphaOrig) bound = TranspositionTable::Bound::Upper;
+        else if (best >= beta) bound = TranspositionTable::Bound::Lower;
+        store(st, key, best, depth, bound);
+        return best;
+    }
+};
+
+// Monte Carlo Tree Search with UCT selection and uniformly random playouts.
+// Nodes live in a preallocated arena (children of a node are contiguous) and
+// the subtree under the position actually reached is kept between moves.
+// With several threads it either shares one tree, using atomic counters and
+// virtual loss to spread threads over different lines, or grows one tree per
+// thread and sums their root statistics.
+class MCTS : public SearchEngine {
+public:
+    enum class Parallelism { Tree, Root };
+
+    explicit MCTS(Cell aiPlayer, std::size_t maxNodes = 1 << 18, std::uint64_t seed = 0x5EED5EEDull)
+        : ai(aiPlayer), maxNodes(std::max<std::size_t>(maxNodes, 2)), seed(seed) {
+        trees.push_back(std::make_unique<Tree>(this->maxNodes));
+    }
+
+    std::pair<int,int> findBestMove(Board board) override {
+        auto start = std::chrono::steady_clock::now();
+        int threads = threadCount();
+        std::size_t treeCount = (pool && parallelism == Parallelism::Root) ? threads : 1;
+        while (trees.size() < treeCount) trees.push_back(std::make_unique<Tree>(maxNodes));
+        trees.resize(treeCount);
+        for (auto &tree: trees) if (!reuseTree(*tree, board)) resetTree(*tree, board);
+
+        bool timed = timeBudget.count() > 0;
+        auto deadline = start + timeBudget;
+        std::atomic<std::uint64_t> claimed{0};
+        std::uint64_t threadPlayouts[MAX_THREADS] = {};
+        ++searches;
+
+        auto work = [&](int thread) {
+            Tree &tree = *trees[treeCount == 1 ? 0 : thread];
+            std::uint64_t rng = seed ^ (searches * 0x9E3779B97F4A7C15ull) ^ ((std::uint64_t)thread << 32);
+            rng = splitMix64(rng) | 1;
+            std::uint64_t done = 0;
+            while (!stopped()) {
+                // the clock is read once every 64 playouts
+                if (timed ? (done % 64 == 0 && std::chrono::steady_clock::now() >= deadline)
+                          : claimed.fetch_add(1, std::memory_order_relaxed) >= iterations) break;
+                runIteration(tree, rng);
+                ++done;
+            }
+            threadPlayouts[thread] = done;
+        };
+        if (pool) pool->run(work);
+        else work(0);
+        playouts = 0;
+        for (std::uint64_t n: threadPlayouts) playouts += n;
+        elapsed = std::chrono::steady_clock::now() - start;
+
+        // most visited move over all trees is the most robust choice
+        std::uint64_t visits[Board::SIZE*Board::SIZE] = {};
+        for (auto &tree: trees) {
+            Node const &r = tree->nodes[tree->root];
+            if (r.state.load(std::memory_order_acquire) != EXPANDED) continue;
+            for (std::uint32_t i = 0; i < r.childCount; ++i) {
+                Node const &child = tree->nodes[r.firstChild + i];
+                visits[child.move] += child.visits.load(std::memory_order_relaxed);
+            }
+        }
+        unsigned empty = board.emptyBits();
+        if (!empty) return {-1,-1};
+        int bestMove = lowestBit(empty);
+        for (unsigned m = empty; m; m &= m - 1) {
+            int cell = lowestBit(m);
+            if (visits[cell] > visits[bestMove]) bestMove = cell;
+        }
+        return {bestMove / Board::SIZE, bestMove % Board::SIZE};
+    }
+
+    // playouts per move (over all threads), used when no time budget is set
+    void setIterations(std::uint64_t count) { iterations = count; }
+    void setTimeBudget(std::chrono::milliseconds budget) { timeBudget = std::max(budget, std::chrono::milliseconds(0)); }
+
+    // 1 = search on the caller only; under Root each thread also gets its own arena of maxNodes
+    void setThreads(int threads) {
+        threads = std::clamp(threads, 1, MAX_THREADS);
+        pool = threads > 1 ? std::make_unique<ThreadPool>(threads) : nullptr;
+    }
+    int threadCount() const { return pool ? pool->size() : 1; }
+    void setParallelism(Parallelism mode) { parallelism = mode; }
+
+    // also drops the trees, so the searches that follow depend on nothing before the call
+    void setSeed(std::uint64_t value) override {
+        seed = value;
+        searches = 0;
+        for (auto &tree: trees) tree->used = 0;
+    }
+
+    std::uint64_t lastPlayouts() const { return playouts; }
+    // playouts count as nodes
+    SearchStats lastStats() const override {
+        SearchStats s;
+        s.nodes = playouts;
+        s.seconds = elapsed.count();
+        return s;
+    }
+    double lastPlayoutsPerSecond() const {
+        return elapsed.count() > 0 ? playouts / elapsed.count() : 0.0;
+    }
+    std::size_t nodesInUse() const {
+        std::size_t n = 0;
+        for (auto &tree: trees) n += std::min(tree->used.load(), tree->capacity);
+        return n;
+    }
+
+private:
+    enum : std::uint8_t { LEAF, EXPANDING, EXPANDED };
 
-// Simple TicTacToe with OOP and SFML GUI
-// Classes: Board, AI, Game, GUI
+    struct Node {
+        std::atomic<std::uint32_t> visits{0};   // includes in-flight descents (virtual loss)
+        std::atomic<std::uint32_t> halfWins{0}; // for the player who made move; a draw is 1, a win 2
+        std::atomic<std::uint8_t> state{LEAF};
+        std::int8_t move = -1;
+        std::uint8_t childCount = 0;            // valid once state is EXPANDED
+        std::uint32_t firstChild = 0;
+    };
 
-enum class Cell { Empty, X, O };
+    struct Tree {
+        explicit Tree(std::size_t capacity): nodes(std::make_unique<Node[]>(capacity)), capacity(capacity) {}
+        std::unique_ptr<Node[]> nodes;
+        std::size_t capacity;
+        std::atomic<std::size_t> used{0};
+        std::uint32_t root = 0;
+        Board rootBoard;
+    };
 
-class Board {
-public:
-    static const int SIZE = 3;
-    Board() { cells.fill(Cell::Empty); }
+    static constexpr float EXPLORATION = 1.41421356f;
+    static constexpr int MAX_THREADS = 256;
+    // longest selection path: root plus one node per cell
+    static constexpr int MAX_PATH = Board::SIZE*Board::SIZE + 1;
 
-    bool makeMove(int r, int c, Cell player) {
-        int idx = r * SIZE + c;
-        if (cells[idx] == Cell::Empty) {
-            cells[idx] = player;
-            return true;
+    Cell ai;
+    std::size_t maxNodes;
+    std::uint64_t seed;
+    std::vector<std::unique_ptr<Tree>> trees;
+    std::unique_ptr<ThreadPool> pool;
+    Parallelism parallelism = Parallelism::Tree;
+    std::uint64_t iterations = 20000;
+    std::chrono::milliseconds timeBudget{0};
+    std::uint64_t searches = 0;
+    std::uint64_t playouts = 0;
+    std::chrono::duration<double> elapsed{0};
+
+    static void initNode(Node &n, int move) {
+        n.visits.store(0, std::memory_order_relaxed);
+        n.halfWins.store(0, std::memory_order_relaxed);
+        n.state.store(LEAF, std::memory_order_relaxed);
+        n.move = (std::int8_t)move;
+        n.childCount = 0;
+        n.firstChild = 0;
+    }
+
+    static void resetTree(Tree &tree, Board const &board) {
+        initNode(tree.nodes[0], -1);
+        tree.used = 1;
+        tree.root = 0;
+        tree.rootBoard = board;
+    }
+
+    static bool samePosition(Board const &a, Board const &b) {
+        return a.bits(Cell::X) == b.bits(Cell::X) && a.bits(Cell::O) == b.bits(Cell::O);
+    }
+
+    // moves the root to the node for board if it is our last move plus a reply
+    // already in the tree; the arena is only cleared once it is mostly used up
+    bool reuseTree(Tree &tree, Board const &board) const {
+        if (tree.used == 0 || tree.used > tree.capacity * 3 / 4) return false;
+        if (samePosition(tree.rootBoard, board)) return true;
+        Node const &r = tree.nodes[tree.root];
+        if (r.state.load(std::memory_order_acquire) != EXPANDED) return false;
+        for (std::uint32_t i = 0; i < r.childCount; ++i) {
+            Node const &child = tree.nodes[r.firstChild + i];
+            if (child.state.load(std::memory_order_acquire) != EXPANDED) continue;
+            Board afterOurs = tree.rootBoard;
+            afterOurs.makeMove(child.move / Board::SIZE, child.move % Board::SIZE, ai);
+            for (std::uint32_t j = 0; j < child.childCount; ++j) {
+                std::uint32_t gi = child.firstChild + j;
+                Board afterReply = afterOurs;
+                afterReply.makeMove(tree.nodes[gi].move / Board::SIZE, tree.nodes[gi].move % Board::SIZE, opponent(ai));
+                if (samePosition(afterReply, board)) {
+                    tree.root = gi;
+                    tree.rootBoard = board;
+                    return true;
+                }
+            }
         }
         return false;
     }
 
-    void undoMove(int r, int c) {
-        cells[r * SIZE + c] = Cell::Empty;
+    // only the thread that wins the LEAF -> EXPANDING race adds children; others
+    // treat the node as a leaf until it is published as EXPANDED
+    static bool expand(Tree &tree, Node &node, Board const &board) {
+        std::uint8_t expected = LEAF;
+        if (!node.state.compare_exchange_strong(expected, EXPANDING, std::memory_order_acquire)) return false;
+        unsigned empty = board.emptyBits();
+        std::size_t count = (std::size_t)popCount(empty);
+        std::size_t first = tree.used.fetch_add(count, std::memory_order_relaxed);
+        if (!count || first + count > tree.capacity) {
+            node.state.store(LEAF, std::memory_order_release);
+            return false;
+        }
+        for (std::size_t i = 0; empty; empty &= empty - 1, ++i) initNode(tree.nodes[first + i], lowestBit(empty));
+        node.firstChild = (std::uint32_t)first;
+        node.childCount = (std::uint8_t)count;
+        node.state.store(EXPANDED, std::memory_order_release);
+        return true;
     }
 
-    std::vector<std::pair<int,int>> availableMoves() const {
-        std::vector<std::pair<int,int>> moves;
-        for (int r = 0; r < SIZE; ++r) for (int c = 0; c < SIZE; ++c)
-            if (cells[r * SIZE + c] == Cell::Empty) moves.emplace_back(r,c);
-        return moves;
+    static std::uint32_t selectChild(Tree const &tree, Node const &parent) {
+        float logVisits = std::log((float)parent.visits.load(std::memory_order_relaxed) + 1.f);
+        std::uint32_t best = parent.firstChild;
+        float bestValue = -1.f;
+        for (std::uint32_t i = 0; i < parent.childCount; ++i) {
+            Node const &child = tree.nodes[parent.firstChild + i];
+            std::uint32_t visits = child.visits.load(std::memory_order_relaxed);
+            if (visits == 0) return parent.firstChild + i;
+            float value = child.halfWins.load(std::memory_order_relaxed) * 0.5f / visits
+                        + EXPLORATION * std::sqrt(logVisits / visits);
+            if (value > bestValue) { bestValue = value; best = parent.firstChild + i; }
+        }
+        return best;
     }
 
-    bool isFull() const {
-        for (auto &v: cells) if (v == Cell::Empty) return false;
-        return true;
+    // plays uniformly random moves to the end; returns the winner, Empty for a draw
+    static Cell playout(Board &board, Cell toMove, std::uint64_t &rng) {
+        for (;;) {
+            unsigned empty = board.emptyBits();
+            int pick = (int)(nextRandom(rng) % (std::uint64_t)popCount(empty));
+            while (pick--) empty &= empty - 1;
+            int cell = lowestBit(empty);
+            MoveResult result = board.makeMove(cell / Board::SIZE, cell % Board::SIZE, toMove);
+            if (result == MoveResult::Win) return toMove;
+            if (result == MoveResult::Draw) return Cell::Empty;
+            toMove = opponent(toMove);
+        }
     }
 
-    std::optional<Cell> checkWinner() const {
-        // rows
-        for (int r=0;r<SIZE;++r) {
-            if (cells[r*SIZE] != Cell::Empty && cells[r*SIZE] == cells[r*SIZE+1] && cells[r*SIZE] == cells[r*SIZE+2])
-                return cells[r*SIZE];
-        }
-        // cols
-        for (int c=0;c<SIZE;++c) {
-            if (cells[c] != Cell::Empty && cells[c] == cells[SIZE + c] && cells[c] == cells[2*SIZE + c])
-                return cells[c];
-        }
-        // diagonals
-        if (cells[0] != Cell::Empty && cells[0] == cells[4] && cells[0] == cells[8]) return cells[0];
-        if (cells[2] != Cell::Empty && cells[2] == cells[4] && cells[2] == cells[6]) return cells[2];
-        return std::nullopt;
+    void runIteration(Tree &tree, std::uint64_t &rng) {
+        Board board = tree.rootBoard;
+        Cell toMove = ai;
+        std::uint32_t path[MAX_PATH];
+        int length = 0;
+        path[length++] = tree.root;
+        tree.nodes[tree.root].visits.fetch_add(1, std::memory_order_relaxed);
+        std::optional<Cell> decided = board.checkWinner();
+        MoveResult last = decided ? MoveResult::Win : board.isFull() ? MoveResult::Draw : MoveResult::Ongoing;
+        Cell winner = decided.value_or(Cell::Empty);
+
+        // selection and expansion; each visit is counted on the way down, so
+        // nodes other threads are in the middle of look like losses (virtual loss)
+        std::uint32_t index = tree.root;
+        while (last == MoveResult::Ongoing) {
+            Node &node = tree.nodes[index];
+            if (node.state.load(std::memory_order_acquire) != EXPANDED && !expand(tree, node, board)) break;
+            std::uint32_t child = selectChild(tree, node);
+            bool fresh = tree.nodes[child].visits.fetch_add(1, std::memory_order_relaxed) == 0;
+            int cell = tree.nodes[child].move;
+            last = board.makeMove(cell / Board::SIZE, cell % Board::SIZE, toMove);
+            if (last == MoveResult::Win) winner = toMove;
+            toMove = opponent(toMove);
+            index = child;
+            path[length++] = child;
+            if (fresh) break;
+        }
+        if (last == MoveResult::Ongoing) winner = playout(board, toMove, rng);
+
+        // backpropagation of the result only; path[0] was entered by the opponent's move
+        Cell mover = opponent(ai);
+        for (int i = 0; i < length; ++i) {
+            if (winner == mover) tree.nodes[path[i]].halfWins.fetch_add(2, std::memory_order_relaxed);
+            else if (winner == Cell::Empty) tree.nodes[path[i]].halfWins.fetch_add(1, std::memory_order_relaxed);
+            mover = opponent(mover);
+        }
     }
+};
+
+// Plays a uniformly random empty cell; baseline opponent for self-play
+class RandomEngine : public SearchEngine {
+public:
+    explicit RandomEngine(std::uint64_t seed = 0x5EED5EEDull): rng(splitMix64(seed) | 1) {}
 
-    Cell get(int r, int c) const { return cells[r*SIZE + c]; }
+    std::pair<int,int> findBestMove(Board board) override {
+        unsigned empty = board.emptyBits();
+        if (!empty) return {-1,-1};
+        int pick = (int)(nextRandom(rng) % (std::uint64_t)popCount(empty));
+        while (pick--) empty &= empty - 1;
+        int cell = lowestBit(empty);
+        return {cell / Board::SIZE, cell % Board::SIZE};
+    }
 
-    void reset() { cells.fill(Cell::Empty); }
+    void setSeed(std::uint64_t seed) override { rng = splitMix64(seed) | 1; }
 
 private:
-    std::array<Cell, SIZE*SIZE> cells;
+    std::uint64_t rng;
 };
 
-// MiniMax AI for TicTacToe
-class AI {
+// Runs AI searches on a background thread so the GUI never blocks on one.
+// Requests and results pass through mutex-guarded queues; each carries the
+// generation it was posted for so stale results can be dropped.
+class SearchWorker {
 public:
-    AI(Cell aiPlayer, Cell humanPlayer): ai(aiPlayer), human(humanPlayer) {}
+    struct Result {
+        std::pair<int,int> move;
+        std::uint64_t generation;
+        SearchStats stats;
+    };
 
-    // returns best move (r,c)
-    std::pair<int,int> findBestMove(Board board) {
-        int bestScore = std::numeric_limits<int>::min();
-        std::pair<int,int> bestMove = {-1,-1};
-        for (auto m: board.availableMoves()) {
-            board.makeMove(m.first, m.second, ai);
-            int score = minimax(board, 0, false);
-            board.undoMove(m.first, m.second);
-            if (score > bestScore) {
-                bestScore = score;
-                bestMove = m;
-            }
+    explicit SearchWorker(SearchEngine &ai): ai(ai), thread([this]{ loop(); }) {}
+
+    ~SearchWorker() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            quit = true;
+            ai.requestStop();
         }
-        return bestMove;
+        wake.notify_one();
+        thread.join();
     }
 
-private:
-    Cell ai, human;
+    SearchWorker(SearchWorker const&) = delete;
+    SearchWorker& operator=(SearchWorker const&) = delete;
 
-    int scoreForWinner(Cell winner) const {
-        if (winner == ai) return 10;
-        if (winner == human) return -10;
-        return 0;
+    void post(Board const &board, std::uint64_t generation) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            requests.push_back({board, generation});
+        }
+        wake.notify_one();
     }
 
-    int minimax(Board &board, int depth, bool isMaximizing) {
-        auto winner = board.checkWinner();
-        if (winner.has_value()) return scoreForWinner(*winner);
-        if (board.isFull()) return 0;
+    // drops queued requests and aborts the search in progress
+    void cancel() {
+        std::lock_guard<std::mutex> lock(mutex);
+        requests.clear();
+        ai.requestStop();
+    }
 
-        if (isMaximizing) {
-            int best = std::numeric_limits<int>::min();
-            for (auto m: board.availableMoves()) {
-                board.makeMove(m.first, m.second, ai);
-                best = std::max(best, minimax(board, depth+1, false));
-                board.undoMove(m.first, m.second);
-            }
-            return best;
-        } else {
-            int best = std::numeric_limits<int>::max();
-            for (auto m: board.availableMoves()) {
-                board.makeMove(m.first, m.second, human);
-                best = std::min(best, minimax(board, depth+1, true));
-                board.undoMove(m.first, m.second);
+    std::optional<Result> poll() {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (results.empty()) return std::nullopt;
+        Result r = results.front();
+        results.pop_front();
+        return r;
+    }
+
+private:
+    struct Request {
+        Board board;
+        std::uint64_t generation;
+    };
+
+    SearchEngine &ai;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<Request> requests;
+    std::deque<Result> results;
+    bool quit = false;
+    std::thread thread; // last, so everything above exists before loop() runs
+
+    void loop() {
+        for (;;) {
+            Request req;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [this]{ return quit || !requests.empty(); });
+                if (quit) return;
+                req = requests.front();
+                requests.pop_front();
+                ai.clearStop();
             }
-            return best;
+            std::pair<int,int> move = ai.findBestMove(req.board);
+            SearchStats stats = ai.lastStats();
+            std::lock_guard<std::mutex> lock(mutex);
+            results.push_back({move, req.generation, stats});
         }
     }
 };
@@ -157,9 +1657,16 @@ private:
 class Game {
 public:
     enum class Mode { HumanVsHuman, HumanVsAI };
-    Game(): board(), current(Cell::X), mode(Mode::HumanVsAI), ai(Cell::O, Cell::X), scoreX(0), scoreO(0) {}
+    enum class Engine { Minimax, MonteCarlo };
+    explicit Game(Engine engine = Engine::Minimax): board(), current(Cell::X), mode(Mode::HumanVsAI), ai(makeEngine(engine)), scoreX(0), scoreO(0) {}
 
     void restart() {
+        // results of searches started before the restart no longer apply
+        ++generation;
+        // only stop the engine when the worker has something to stop; the
+        // worker clears the flag when it starts its next search, nobody else does
+        if (aiPending) worker.cancel();
+        aiPending = false;
         board.reset();
         current = Cell::X;
         over = false;
@@ -168,23 +1675,49 @@ public:
 
     bool playMove(int r, int c) {
         if (over) return false;
-        if (board.get(r,c) != Cell::Empty) return false;
-        board.makeMove(r,c,current);
-        checkGameState();
+        MoveResult result = board.makeMove(r,c,current);
+        if (result == MoveResult::Illegal) return false;
+        checkGameState(result);
         if (!over) switchTurn();
         return true;
     }
 
+    // synchronous; only for callers that never use requestAiMove
     void aiMove() {
         if (over) return;
-        auto [r,c] = ai.findBestMove(board);
-        if (r>=0) {
-            board.makeMove(r,c, Cell::O);
-            checkGameState();
-            if (!over) switchTurn();
+        ai->clearStop();
+        std::pair<int,int> move = ai->findBestMove(board);
+        recordStats(ai->lastStats());
+        applyAiMove(move);
+    }
+
+    // starts a background search for the AI's reply; pollAiMove picks it up
+    void requestAiMove() {
+        if (over || aiPending) return;
+        aiPending = true;
+        worker.post(board, generation);
+    }
+
+    // applies a finished background search, if any; returns true when a move was made
+    bool pollAiMove() {
+        while (auto result = worker.poll()) {
+            if (result->generation != generation) continue;
+            aiPending = false;
+            recordStats(result->stats);
+            applyAiMove(result->move);
+            return true;
         }
+        return false;
     }
 
+    bool isAiPending() const { return aiPending; }
+
+    // stats of the search behind the AI's last move
+    SearchStats const& lastSearchStats() const { return searchStats; }
+    // prints them to std::clog after every AI move
+    void setLogSearchStats(bool enabled) { logStats = enabled; }
+    bool logsSearchStats() const { return logStats; }
+
     void setMode(Mode m) { mode = m; }
     Mode getMode() const { return mode; }
     Cell currentPlayer() const { return current; }
@@ -198,7 +1731,12 @@ private:
     Board board;
     Cell current;
     Mode mode;
-    AI ai{Cell::O, Cell::X};
+    std::unique_ptr<SearchEngine> ai;
+    SearchWorker worker{*ai};
+    std::uint64_t generation = 0;
+    bool aiPending = false;
+    SearchStats searchStats;
+    bool logStats = false;
     bool over = false;
     std::optional<Cell> winnerOpt;
     int scoreX;
@@ -206,95 +1744,302 @@ private:
 
     void switchTurn() { current = (current==Cell::X?Cell::O:Cell::X); }
 
-    void checkGameState() {
-        auto w = board.checkWinner();
-        if (w.has_value()) {
+    static std::unique_ptr<SearchEngine> makeEngine(Engine engine) {
+        if (engine == Engine::MonteCarlo) return std::make_unique<MCTS>(Cell::O);
+        return std::make_unique<AI>(Cell::O, Cell::X);
+    }
+
+    void recordStats(SearchStats const &stats) {
+        searchStats = stats;
+        if (logStats) std::clog << "ai move " << stats << "\n";
+    }
+
+    void applyAiMove(std::pair<int,int> move) {
+        auto [r,c] = move;
+        if (r>=0) {
+            checkGameState(board.makeMove(r,c, Cell::O));
+            if (!over) switchTurn();
+        }
+    }
+
+    // result of the move just made by the current player
+    void checkGameState(MoveResult result) {
+        if (result == MoveResult::Win) {
             over = true;
-            winnerOpt = w;
-            if (*w == Cell::X) ++scoreX; else ++scoreO;
-        } else if (board.isFull()) {
+            winnerOpt = current;
+            if (current == Cell::X) ++scoreX; else ++scoreO;
+        } else if (result == MoveResult::Draw) {
             over = true;
             winnerOpt = std::nullopt; // draw
         }
     }
 };
 
+// Timings of the last HISTORY frames, for the GUI's profiler overlay and CSV export
+class FrameProfiler {
+public:
+    struct Frame {
+        float frameMs;
+        float eventsMs;
+        float updateMs;
+        float renderMs;
+        float aiMs;    // search time of an AI move applied this frame, else 0
+        int drawCalls;
+    };
+
+    static constexpr int HISTORY = 600;
+    // frame-time histogram: BUCKETS buckets of BUCKET_MS, the last one open-ended
+    static constexpr int BUCKETS = 20;
+    static constexpr float BUCKET_MS = 2.f;
+
+    void record(Frame const &f) { frames[recorded++ % HISTORY] = f; }
+
+    int count() const { return (int)std::min<std::uint64_t>(recorded, HISTORY); }
+    // i == 0 is the oldest frame kept
+    Frame const& at(int i) const { return frames[(recorded - count() + i) % HISTORY]; }
+    Frame const& last() const { return at(count() - 1); }
+
+    float averageFrameMs() const {
+        float total = 0;
+        for (int i = 0; i < count(); ++i) total += at(i).frameMs;
+        return count() ? total / count() : 0.f;
+    }
+
+    std::array<int, BUCKETS> histogram() const {
+        std::array<int, BUCKETS> buckets{};
+        for (int i = 0; i < count(); ++i)
+            ++buckets[std::min((int)(at(i).frameMs / BUCKET_MS), BUCKETS - 1)];
+        return buckets;
+    }
+
+    bool exportCsv(std::string const &path) const {
+        std::ofstream out(path);
+        if (!out) return false;
+        out << "frame,frame_ms,events_ms,update_ms,render_ms,ai_ms,draw_calls\n";
+        std::uint64_t first = recorded - count();
+        for (int i = 0; i < count(); ++i) {
+            Frame const &f = at(i);
+            out << first + i << ',' << f.frameMs << ',' << f.eventsMs << ',' << f.updateMs << ','
+                << f.renderMs << ',' << f.aiMs << ',' << f.drawCalls << '\n';
+        }
+        return (bool)out;
+    }
+
+private:
+    std::array<Frame, HISTORY> frames{};
+    std::uint64_t recorded = 0;
+};
+
 // GUI wrapper using SFML
 class GUI {
 public:
-    GUI(Game &game): game(game), window(sf::VideoMode(600,700), "TicTacToe - C++ SFML") {
+    // Offscreen draws into a RenderTexture and opens no window; it still needs an
+    // OpenGL context, e.g. under Xvfb
+    enum class Output { Window, Offscreen };
+
+    explicit GUI(Game &game, Output output = Output::Window): game(game) {
+        if (output == Output::Window) {
+            window.create(sf::VideoMode(600,700), "TicTacToe - C++ SFML");
+        } else if (offscreen.create(600,700)) {
+            canvas = &offscreen;
+            offscreenReady = true;
+        } else {
+            std::cerr << "Error: failed to create the offscreen render texture.\n";
+        }
         if (!font.loadFromFile("assets/font.ttf")) {
             std::cerr << "Warning: failed to load assets/font.ttf. Text may not display.\n";
         }
         cellSize = 600 / Board::SIZE; // square
         gridOffset = {0,0};
-        setupShapes();
+        buildStaticGeometry();
+        setupTexts();
     }
 
+    // Sleeps in waitEvent while nothing can change on its own, wakes every
+    // AI_POLL_MS while the AI is to move, and redraws only after a change.
+    // Frame times exclude the time spent waiting.
     void run() {
         while (window.isOpen()) {
+            sf::Event first;
+            bool woken = !continuous && !dirty && !aiTurn() && window.waitEvent(first);
+            sf::Clock frameClock, phase;
+            if (woken) handleEvent(first);
             handleEvents();
+            float eventsMs = phase.restart().asMicroseconds() / 1000.f;
+            aiMoveMs = 0;
             update();
+            float updateMs = phase.restart().asMicroseconds() / 1000.f;
+            if (!continuous && !dirty) {
+                sf::sleep(sf::milliseconds(AI_POLL_MS));
+                continue;
+            }
+            drawCalls = 0;
             render();
+            dirty = false;
+            float renderMs = phase.restart().asMicroseconds() / 1000.f;
+            profiler.record({frameClock.restart().asMicroseconds() / 1000.f, eventsMs, updateMs, renderMs, aiMoveMs, drawCalls});
+        }
+    }
+
+    // redraw every pass as fast as possible instead (the old behaviour), e.g. to profile
+    // rendering; F4 toggles it
+    void setContinuousRendering(bool enabled) { continuous = enabled; }
+
+    bool isOpen() const { return canvas == &offscreen ? offscreenReady : window.isOpen(); }
+
+    // mean per-frame cost of each phase of runScript, in milliseconds
+    struct ScriptTimings {
+        int frames = 0;
+        double seconds = 0;
+        double stateMs = 0, drawMs = 0, presentMs = 0, captureMs = 0;
+        double drawCalls = 0;
+    };
+
+    // Renders frames frames, each after one step of a fixed script of games (a draw,
+    // an X win, an O win) played in HumanVsHuman mode. With pngDir set, the first
+    // pass over the script is saved as pngDir/frame_NNN.png for image comparison.
+    ScriptTimings runScript(int frames, std::string const &pngDir = "") {
+        // cells to play; -1 starts a new game
+        static constexpr int SCRIPT[] = {
+            4,0,8,2,1,7,6,3,5,-1,
+            0,4,1,3,2,-1,
+            0,4,1,2,8,6,-1,
+        };
+        constexpr int SCRIPT_LENGTH = (int)(sizeof SCRIPT / sizeof SCRIPT[0]);
+        game.setMode(Game::Mode::HumanVsHuman);
+        game.restart();
+        ScriptTimings t;
+        sf::Clock total;
+        for (int frame = 0; frame < frames; ++frame) {
+            sf::Clock phase;
+            int step = SCRIPT[frame % SCRIPT_LENGTH];
+            if (step < 0) game.restart();
+            else game.playMove(step / Board::SIZE, step % Board::SIZE);
+            t.stateMs += phase.restart().asMicroseconds() / 1000.0;
+            drawCalls = 0;
+            drawFrame();
+            t.drawMs += phase.restart().asMicroseconds() / 1000.0;
+            t.drawCalls += drawCalls;
+            present();
+            t.presentMs += phase.restart().asMicroseconds() / 1000.0;
+            if (!pngDir.empty() && frame < SCRIPT_LENGTH && canvas == &offscreen) {
+                char name[32];
+                std::snprintf(name, sizeof name, "/frame_%03d.png", frame);
+                if (!offscreen.getTexture().copyToImage().saveToFile(pngDir + name))
+                    std::cerr << "Warning: failed to write " << pngDir + name << "\n";
+                t.captureMs += phase.restart().asMicroseconds() / 1000.0;
+            }
         }
+        t.frames = frames;
+        t.seconds = total.getElapsedTime().asMicroseconds() / 1e6;
+        if (frames > 0) {
+            t.stateMs /= frames; t.drawMs /= frames; t.presentMs /= frames;
+            t.captureMs /= frames; t.drawCalls /= frames;
+        }
+        return t;
     }
 
 private:
     Game &game;
     sf::RenderWindow window;
+    sf::RenderTexture offscreen;
+    sf::RenderTarget *canvas = &window; // window or offscreen
+    bool offscreenReady = false;
     sf::Font font;
     int cellSize;
     sf::Vector2f gridOffset;
-    sf::RectangleShape lines[4];
+    // grid lines, separator and button backgrounds, drawn in one call
+    sf::VertexArray staticGeometry{sf::Quads};
+    sf::RectangleShape gameOverShade;
+    // every cell owns MARK_VERTICES vertices of marks (an X uses the first 8, the
+    // rest stay degenerate); only cells whose contents changed are rewritten
+    static constexpr int RING_SEGMENTS = 30;
+    static constexpr int MARK_VERTICES = 4 * RING_SEGMENTS;
+    sf::VertexArray marks{sf::Quads, (std::size_t)(Board::SIZE*Board::SIZE*MARK_VERTICES)};
+    unsigned shownX = 0, shownO = 0; // what marks currently holds
+    // bottom UI and game-over texts; strings are reset only when what they show changes
+    sf::Text restartLabel, modeLabel, scoreLabel, turnLabel, gameOverTitle, gameOverHint;
+    using TextState = std::tuple<int, int, Game::Mode, bool, Cell, Cell>; // scores, mode, over, turn, winner
+    std::optional<TextState> shownTexts;
     sf::Color bgColor = sf::Color(30,30,30);
+    bool showStats = false;
+    bool continuous = false;
+    bool dirty = true; // something visible changed since the last render
+    static constexpr int AI_POLL_MS = 10;
+    FrameProfiler profiler;
+    bool showProfiler = false;
+    int drawCalls = 0;
+    float aiMoveMs = 0, lastAiMoveMs = 0;
+
+    static void addRect(sf::VertexArray &va, float x, float y, float w, float h, sf::Color color) {
+        va.append(sf::Vertex(sf::Vector2f(x, y), color));
+        va.append(sf::Vertex(sf::Vector2f(x + w, y), color));
+        va.append(sf::Vertex(sf::Vector2f(x + w, y + h), color));
+        va.append(sf::Vertex(sf::Vector2f(x, y + h), color));
+    }
 
-    void setupShapes() {
+    // everything that only depends on the layout; rebuild when the layout changes
+    void buildStaticGeometry() {
         float thickness = 4.f;
-        // vertical lines
-        for (int i=0;i<2;++i) {
-            lines[i].setSize(sf::Vector2f(thickness, (float)600));
-            lines[i].setPosition((i+1)*cellSize - thickness/2.f, 0.f);
-            lines[i].setFillColor(sf::Color::White);
-        }
-        // horizontal lines
-        for (int i=0;i<2;++i) {
-            lines[2+i].setSize(sf::Vector2f((float)600, thickness));
-            lines[2+i].setPosition(0.f, (i+1)*cellSize - thickness/2.f);
-            lines[2+i].setFillColor(sf::Color::White);
+        staticGeometry.clear();
+        for (int i=1;i<Board::SIZE;++i) {
+            addRect(staticGeometry, i*cellSize - thickness/2.f, 0.f, thickness, 600.f, sf::Color::White);
+            addRect(staticGeometry, 0.f, i*cellSize - thickness/2.f, 600.f, thickness, sf::Color::White);
         }
+        // separator, Restart and Toggle Mode buttons
+        addRect(staticGeometry, 0.f, 600.f, 600.f, 2.f, sf::Color::White);
+        addRect(staticGeometry, 50.f, 620.f, 200.f, 50.f, sf::Color(80,80,80));
+        addRect(staticGeometry, 350.f, 620.f, 200.f, 50.f, sf::Color(80,80,80));
+
+        gameOverShade.setSize(sf::Vector2f(600.f, 600.f));
+        gameOverShade.setFillColor(sf::Color(0,0,0,120));
     }
 
     void handleEvents() {
         sf::Event event;
-        while (window.pollEvent(event)) {
-            if (event.type == sf::Event::Closed) window.close();
-            if (event.type == sf::Event::MouseButtonPressed) {
-                if (event.mouseButton.button == sf::Mouse::Left) {
-                    int mx = event.mouseButton.x;
-                    int my = event.mouseButton.y;
-                    if (my <= 600) {
-                        int r = my / cellSize;
-                        int c = mx / cellSize;
-                        if (game.getMode() == Game::Mode::HumanVsHuman) {
-                            game.playMove(r,c);
-                        } else {
-                            if (game.currentPlayer() == Cell::X) {
-                                if (game.playMove(r,c)) {
-                                    // AI turn
-                                    if (!game.isOver()) game.aiMove();
-                                }
+        while (window.pollEvent(event)) handleEvent(event);
+    }
+
+    void handleEvent(sf::Event const &event) {
+        if (event.type != sf::Event::MouseMoved) dirty = true;
+        if (event.type == sf::Event::Closed) window.close();
+        // the layout uses fixed 600x700 view coordinates today, so this rebuilds the same
+        // geometry; it is the one place to update once layout follows the window size
+        if (event.type == sf::Event::Resized) {
+            buildStaticGeometry();
+            syncMarks(true);
+        }
+        if (event.type == sf::Event::MouseButtonPressed) {
+            if (event.mouseButton.button == sf::Mouse::Left) {
+                int mx = event.mouseButton.x;
+                int my = event.mouseButton.y;
+                if (my <= 600) {
+                    int r = my / cellSize;
+                    int c = mx / cellSize;
+                    if (game.getMode() == Game::Mode::HumanVsHuman) {
+                        game.playMove(r,c);
+                    } else {
+                        if (game.currentPlayer() == Cell::X) {
+                            if (game.playMove(r,c)) {
+                                // AI turn, searched off the render thread
+                                if (!game.isOver()) game.requestAiMove();
                             }
                         }
-                    } else {
-                        // bottom area for buttons
-                        handleBottomClick(mx, my);
                     }
+                } else {
+                    // bottom area for buttons
+                    handleBottomClick(mx, my);
                 }
             }
-            if (event.type == sf::Event::KeyPressed) {
-                if (event.key.code == sf::Keyboard::R) game.restart();
-                if (event.key.code == sf::Keyboard::M) toggleMode();
-            }
+        }
+        if (event.type == sf::Event::KeyPressed) {
+            if (event.key.code == sf::Keyboard::R) game.restart();
+            if (event.key.code == sf::Keyboard::M) toggleMode();
+            if (event.key.code == sf::Keyboard::F1) showStats = !showStats;
+            if (event.key.code == sf::Keyboard::L) game.setLogSearchStats(!game.logsSearchStats());
+            if (event.key.code == sf::Keyboard::F2) showProfiler = !showProfiler;
+            if (event.key.code == sf::Keyboard::F3) exportProfile();
+            if (event.key.code == sf::Keyboard::F4) setContinuousRendering(!continuous);
         }
     }
 
@@ -317,111 +2062,163 @@ private:
     }
 
     void update() {
-        // If AI vs Human and it's AI's turn, make AI move (safeguarded to not busy loop)
-        if (game.getMode() == Game::Mode::HumanVsAI && !game.isOver() && game.currentPlayer() == Cell::O) {
+        // apply the AI's move once the worker has finished searching
+        if (game.pollAiMove()) {
+            aiMoveMs = lastAiMoveMs = (float)(game.lastSearchStats().seconds * 1000);
+            dirty = true;
+        }
+        // If AI vs Human and it's AI's turn with no search running, start one (safeguarded to not busy loop)
+        if (aiTurn() && !game.isAiPending()) {
             // small delay to improve UX
             static sf::Clock cooldown; static bool started = false;
             if (!started) { cooldown.restart(); started = true; }
             if (cooldown.getElapsedTime().asMilliseconds() > 300) {
-                game.aiMove();
+                game.requestAiMove();
                 started = false;
             }
         }
     }
 
+    // the AI's move is due or being searched; the only state that changes without an event
+    bool aiTurn() const {
+        return game.getMode() == Game::Mode::HumanVsAI && !game.isOver() && game.currentPlayer() == Cell::O;
+    }
+
     void render() {
-        window.clear(bgColor);
-        drawGrid();
+        drawFrame();
+        present();
+    }
+
+    void drawFrame() {
+        canvas->clear(bgColor);
+        draw(staticGeometry);
         drawMarks();
         drawBottomUI();
-        window.display();
+        if (showStats) drawStatsOverlay();
+        if (showProfiler) drawProfilerOverlay();
+    }
+
+    void present() {
+        if (canvas == &offscreen) offscreen.display();
+        else window.display();
     }
 
-    void drawGrid() {
-        for (int i=0;i<4;++i) window.draw(lines[i]);
+    // every draw goes through here so the profiler can count them
+    void draw(sf::Drawable const &drawable) {
+        canvas->draw(drawable);
+        ++drawCalls;
     }
 
     void drawMarks() {
-        Board const &board = game.getBoard();
-        for (int r=0;r<Board::SIZE;++r) for (int c=0;c<Board::SIZE;++c) {
-            Cell cell = board.get(r,c);
-            float x = c * cellSize;
-            float y = r * cellSize;
-            if (cell == Cell::X) drawX(x,y);
-            else if (cell == Cell::O) drawO(x,y);
-        }
+        syncMarks();
+        draw(marks);
         if (game.isOver()) {
-            sf::RectangleShape overlay(sf::Vector2f(600,600));
-            overlay.setFillColor(sf::Color(0,0,0,120));
-            window.draw(overlay);
+            draw(gameOverShade);
             drawGameOver();
         }
     }
 
-    void drawX(float x, float y) {
-        float pad = cellSize * 0.2f;
-        sf::RectangleShape l1(sf::Vector2f(cellSize - 2*pad, 6.f));
-        l1.setOrigin(0, 3.f);
-        l1.setPosition(x + pad, y + pad);
-        l1.setRotation(45.f);
-        l1.setFillColor(sf::Color::Red);
-
-        sf::RectangleShape l2(sf::Vector2f(cellSize - 2*pad, 6.f));
-        l2.setOrigin(0, 3.f);
-        l2.setPosition(x + cellSize - pad, y + pad);
-        l2.setRotation(135.f);
-        l2.setFillColor(sf::Color::Red);
+    // brings marks up to date with the board; all rewrites every cell
+    void syncMarks(bool all = false) {
+        Board const &board = game.getBoard();
+        unsigned x = board.bits(Cell::X), o = board.bits(Cell::O);
+        unsigned changed = all ? Board::FULL : (x ^ shownX) | (o ^ shownO);
+        for (; changed; changed &= changed - 1) {
+            int idx = lowestBit(changed);
+            unsigned bit = 1u << idx;
+            writeMark(idx, (x & bit) ? Cell::X : (o & bit) ? Cell::O : Cell::Empty);
+        }
+        shownX = x;
+        shownO = o;
+    }
 
-        window.draw(l1);
-        window.draw(l2);
+    void writeMark(int idx, Cell cell) {
+        sf::Vertex *v = &marks[idx * MARK_VERTICES];
+        for (int i = 0; i < MARK_VERTICES; ++i) v[i] = sf::Vertex();
+        float x = (idx % Board::SIZE) * cellSize, y = (idx / Board::SIZE) * cellSize;
+        if (cell == Cell::X) {
+            // two bars 6 px thick at 45 and 135 degrees
+            float pad = cellSize * 0.2f, length = cellSize - 2*pad, half = 3.f, k = 0.70710678f;
+            sf::Vector2f starts[2] = {{x + pad, y + pad}, {x + cellSize - pad, y + pad}};
+            sf::Vector2f dirs[2] = {{k, k}, {-k, k}};
+            for (int b = 0; b < 2; ++b) {
+                sf::Vector2f d = dirs[b], n(-d.y, d.x), p = starts[b];
+                v[4*b]   = sf::Vertex(p - n*half, sf::Color::Red);
+                v[4*b+1] = sf::Vertex(p + d*length - n*half, sf::Color::Red);
+                v[4*b+2] = sf::Vertex(p + d*length + n*half, sf::Color::Red);
+                v[4*b+3] = sf::Vertex(p + n*half, sf::Color::Red);
+            }
+        } else if (cell == Cell::O) {
+            // ring with a 6 px outline outside the radius, like CircleShape's outline
+            float pad = cellSize * 0.18f, radius = (cellSize - 2*pad) / 2.f, thickness = 6.f;
+            sf::Vector2f centre(x + pad + radius, y + pad + radius);
+            for (int i = 0; i < RING_SEGMENTS; ++i) {
+                float a0 = 2 * 3.14159265f * i / RING_SEGMENTS, a1 = 2 * 3.14159265f * (i + 1) / RING_SEGMENTS;
+                sf::Vector2f u0(std::cos(a0), std::sin(a0)), u1(std::cos(a1), std::sin(a1));
+                v[4*i]   = sf::Vertex(centre + u0*radius, sf::Color::Cyan);
+                v[4*i+1] = sf::Vertex(centre + u0*(radius + thickness), sf::Color::Cyan);
+                v[4*i+2] = sf::Vertex(centre + u1*(radius + thickness), sf::Color::Cyan);
+                v[4*i+3] = sf::Vertex(centre + u1*radius, sf::Color::Cyan);
+            }
+        }
     }
 
-    void drawO(float x, float y) {
-        float pad = cellSize * 0.18f;
-        sf::CircleShape circle((cellSize - 2*pad)/2.f);
-        circle.setPosition(x + pad, y + pad);
-        circle.setOutlineThickness(6.f);
-        circle.setFillColor(sf::Color::Transparent);
-        circle.setOutlineColor(sf::Color::Cyan);
-        window.draw(circle);
+    void setupTexts() {
+        // rasterize every printable ASCII glyph at the sizes used, so no frame pays for it
+        for (unsigned size: {11u, 14u, 16u, 18u, 20u, 48u})
+            for (sf::Uint32 ch = 32; ch < 127; ++ch) font.getGlyph(ch, size, false);
+
+        sf::Text *texts[] = {&restartLabel, &modeLabel, &scoreLabel, &turnLabel, &gameOverTitle, &gameOverHint};
+        for (sf::Text *t: texts) {
+            t->setFont(font);
+            t->setFillColor(sf::Color::White);
+        }
+        restartLabel.setCharacterSize(20);
+        restartLabel.setString("Restart (R)");
+        restartLabel.setPosition(60, 630);
+        modeLabel.setCharacterSize(18);
+        modeLabel.setPosition(360, 630);
+        scoreLabel.setCharacterSize(16);
+        scoreLabel.setPosition(250, 610);
+        turnLabel.setCharacterSize(16);
+        turnLabel.setPosition(10, 580);
+        gameOverTitle.setCharacterSize(48);
+        gameOverTitle.setFillColor(sf::Color::Yellow);
+        gameOverHint.setCharacterSize(16);
+        gameOverHint.setString("Click Restart or press R to play again");
+        sf::FloatRect sbb = gameOverHint.getLocalBounds();
+        gameOverHint.setPosition((600 - sbb.width)/2.f, (600 - sbb.height)/2.f + 30);
     }
 
-    void drawBottomUI() {
-        // Draw separator
-        sf::RectangleShape sep(sf::Vector2f(600.f, 2.f));
-        sep.setPosition(0,600);
-        sep.setFillColor(sf::Color::White);
-        window.draw(sep);
-
-        // Restart button
-        sf::RectangleShape restartBtn(sf::Vector2f(200,50));
-        restartBtn.setPosition(50,620);
-        restartBtn.setFillColor(sf::Color(80,80,80));
-        window.draw(restartBtn);
-        drawText("Restart (R)", 60, 630, 20);
-
-        // Toggle Mode button
-        sf::RectangleShape modeBtn(sf::Vector2f(200,50));
-        modeBtn.setPosition(350,620);
-        modeBtn.setFillColor(sf::Color(80,80,80));
-        window.draw(modeBtn);
-        std::string modeText = (game.getMode()==Game::Mode::HumanVsHuman)?"Human vs Human (M)":"Human vs AI (M)";
-        drawText(modeText, 360, 630, 18);
-
-        // Score
-        std::string scoreStr = "X: " + std::to_string(game.getScoreX()) + "    O: " + std::to_string(game.getScoreO());
-        drawText(scoreStr, 250, 610, 16);
-
-        // Current turn
-        std::string turnText;
+    void updateTexts() {
+        std::optional<Cell> winner = game.winner();
+        TextState state{game.getScoreX(), game.getScoreO(), game.getMode(), game.isOver(),
+                        game.currentPlayer(), winner.value_or(Cell::Empty)};
+        if (shownTexts == state) return;
+        shownTexts = state;
+
+        modeLabel.setString((game.getMode()==Game::Mode::HumanVsHuman)?"Human vs Human (M)":"Human vs AI (M)");
+        scoreLabel.setString("X: " + std::to_string(game.getScoreX()) + "    O: " + std::to_string(game.getScoreO()));
         if (!game.isOver()) {
-            turnText = (game.currentPlayer()==Cell::X)?"Turn: X":"Turn: O";
+            turnLabel.setString((game.currentPlayer()==Cell::X)?"Turn: X":"Turn: O");
         } else {
-            if (game.winner().has_value()) {
-                turnText = (*game.winner()==Cell::X)?"Winner: X":"Winner: O";
-            } else turnText = "Draw";
+            if (winner.has_value()) {
+                turnLabel.setString((*winner==Cell::X)?"Winner: X":"Winner: O");
+            } else turnLabel.setString("Draw");
+            gameOverTitle.setString(winner.has_value() ? ((*winner==Cell::X)?"X Wins!":"O Wins!") : "Draw!");
+            sf::FloatRect bb = gameOverTitle.getLocalBounds();
+            gameOverTitle.setPosition((600 - bb.width)/2.f, (600 - bb.height)/2.f - 20);
         }
-        drawText(turnText, 10, 580, 16);
+    }
+
+    // separator and button backgrounds are part of staticGeometry
+    void drawBottomUI() {
+        if (font.getInfo().family.empty()) return; // no font loaded; skip drawing text
+        updateTexts();
+        draw(restartLabel);
+        draw(modeLabel);
+        draw(scoreLabel);
+        draw(turnLabel);
     }
 
     void drawText(const std::string &text, float x, float y, unsigned int size) {
@@ -429,39 +2226,671 @@ private:
             sf::Text t(text, font, size);
             t.setPosition(x,y);
             t.setFillColor(sf::Color::White);
-            window.draw(t);
+            draw(t);
         } else {
             // no font loaded; skip drawing text
         }
     }
 
+    // debug overlay (F1) with the stats of the AI's last search
+    void drawStatsOverlay() {
+        SearchStats const &s = game.lastSearchStats();
+        sf::RectangleShape panel(sf::Vector2f(250.f, 112.f));
+        panel.setPosition(5.f, 5.f);
+        panel.setFillColor(sf::Color(0,0,0,180));
+        draw(panel);
+        char line[64];
+        std::snprintf(line, sizeof line, "nodes %llu  terminal %llu", (unsigned long long)s.nodes, (unsigned long long)s.terminalNodes);
+        drawText(line, 12, 10, 14);
+        std::snprintf(line, sizeof line, "tt hits %llu  cutoffs %llu", (unsigned long long)s.ttHits, (unsigned long long)s.cutoffs);
+        drawText(line, 12, 30, 14);
+        std::snprintf(line, sizeof line, "max depth %d", s.maxDepth);
+        drawText(line, 12, 50, 14);
+        std::snprintf(line, sizeof line, "time %.3f ms  %.2f Mnodes/s", s.seconds * 1e3, s.nodesPerSecond() / 1e6);
+        drawText(line, 12, 70, 14);
+        drawText(game.logsSearchStats() ? "logging on (L)" : "logging off (L)", 12, 90, 14);
+    }
+
+    // frame profiler overlay (F2): timings of the previous frame, average and a frame-time histogram
+    void drawProfilerOverlay() {
+        if (!profiler.count()) return;
+        FrameProfiler::Frame const &f = profiler.last();
+        float px = 345.f, py = 5.f;
+        sf::RectangleShape panel(sf::Vector2f(250.f, 190.f));
+        panel.setPosition(px, py);
+        panel.setFillColor(sf::Color(0,0,0,180));
+        draw(panel);
+        char line[64];
+        std::snprintf(line, sizeof line, "frame %.2f ms  avg %.2f ms", f.frameMs, profiler.averageFrameMs());
+        drawText(line, px + 7, py + 5, 14);
+        std::snprintf(line, sizeof line, "events %.2f  update %.2f  render %.2f", f.eventsMs, f.updateMs, f.renderMs);
+        drawText(line, px + 7, py + 25, 14);
+        std::snprintf(line, sizeof line, "draw calls %d  ai move %.2f ms", f.drawCalls, lastAiMoveMs);
+        drawText(line, px + 7, py + 45, 14);
+
+        // one bar per bucket, all in one vertex array
+        std::array<int, FrameProfiler::BUCKETS> buckets = profiler.histogram();
+        int most = std::max(*std::max_element(buckets.begin(), buckets.end()), 1);
+        float barWidth = 236.f / FrameProfiler::BUCKETS, baseY = py + 180.f, maxHeight = 100.f;
+        sf::VertexArray bars(sf::Quads, 4 * FrameProfiler::BUCKETS);
+        for (int i = 0; i < FrameProfiler::BUCKETS; ++i) {
+            float x0 = px + 7 + i * barWidth, x1 = x0 + barWidth - 1, y0 = baseY - maxHeight * buckets[i] / most;
+            sf::Color color = i * FrameProfiler::BUCKET_MS < 16.f ? sf::Color::Green : sf::Color::Red;
+            bars[4*i]   = sf::Vertex(sf::Vector2f(x0, baseY), color);
+            bars[4*i+1] = sf::Vertex(sf::Vector2f(x0, y0), color);
+            bars[4*i+2] = sf::Vertex(sf::Vector2f(x1, y0), color);
+            bars[4*i+3] = sf::Vertex(sf::Vector2f(x1, baseY), color);
+        }
+        draw(bars);
+        std::snprintf(line, sizeof line, "frame times, %g ms buckets, last %d frames", FrameProfiler::BUCKET_MS, profiler.count());
+        drawText(line, px + 7, py + 62, 11);
+    }
+
+    void exportProfile() {
+        if (profiler.exportCsv("frame_profile.csv"))
+            std::cout << "Wrote " << profiler.count() << " frames to frame_profile.csv\n";
+        else
+            std::cerr << "Warning: failed to write frame_profile.csv\n";
+    }
+
     void drawGameOver() {
-        std::string t;
-        if (game.winner().has_value()) {
-            t = (*game.winner()==Cell::X)?"X Wins!":"O Wins!";
-        } else t = "Draw!";
-        if (!font.getInfo().family.empty()) {
-            sf::Text txt(t, font, 48);
-            txt.setFillColor(sf::Color::Yellow);
-            sf::FloatRect bb = txt.getLocalBounds();
-            txt.setPosition((600 - bb.width)/2.f, (600 - bb.height)/2.f - 20);
-            window.draw(txt);
+        if (font.getInfo().family.empty()) return;
+        updateTexts();
+        draw(gameOverTitle);
+        draw(gameOverHint);
+    }
+};
+
+#ifdef TICTACTOE_BENCH
+// Benchmarks for the tictactoe_bench target; results go to stdout as JSON
+
+struct BenchResult {
+    std::string name;
+    double nsPerOp;
+    std::uint64_t iterations;
+    int threads;
+};
+
+std::vector<BenchResult> benchResults;
+
+// keeps benchmarked results from being optimized away
+volatile std::uint64_t benchSink = 0;
+
+// runs fn in doubling batches until one takes at least 100 ms; records ns per call
+template <class Fn>
+void bench(std::string name, Fn &&fn, int threads = 1) {
+    for (std::uint64_t iterations = 1;; iterations *= 2) {
+        auto start = std::chrono::steady_clock::now();
+        for (std::uint64_t i = 0; i < iterations; ++i) fn(i);
+        std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+        if (elapsed.count() >= 1e8 || iterations >= (1ull << 40)) {
+            benchResults.push_back({std::move(name), elapsed.count() / iterations, iterations, threads});
+            return;
+        }
+    }
+}
+
+// like bench, but runs setup() untimed before every call and times each call of fn on
+// its own; stops once the timed calls add up to 100 ms or a batch takes a second
+template <class Setup, class Fn>
+void benchWithSetup(std::string name, Setup &&setup, Fn &&fn, int threads = 1) {
+    for (std::uint64_t iterations = 1;; iterations *= 2) {
+        std::chrono::duration<double, std::nano> timed{0};
+        auto batchStart = std::chrono::steady_clock::now();
+        for (std::uint64_t i = 0; i < iterations; ++i) {
+            setup();
+            auto start = std::chrono::steady_clock::now();
+            fn(i);
+            timed += std::chrono::steady_clock::now() - start;
+        }
+        std::chrono::duration<double> batch = std::chrono::steady_clock::now() - batchStart;
+        if (timed.count() >= 1e8 || batch.count() >= 1.0 || iterations >= (1ull << 40)) {
+            benchResults.push_back({std::move(name), timed.count() / iterations, iterations, threads});
+            return;
+        }
+    }
+}
+
+void printBenchJson() {
+    std::cout << "{\n  \"benchmarks\": [\n";
+    for (std::size_t i = 0; i < benchResults.size(); ++i) {
+        BenchResult const &r = benchResults[i];
+        std::cout << "    {\"name\": \"" << r.name << "\", \"ns_per_op\": " << r.nsPerOp
+                  << ", \"iterations\": " << r.iterations << ", \"threads\": " << r.threads << "}"
+                  << (i + 1 < benchResults.size() ? ",\n" : "\n");
+    }
+    std::cout << "  ]\n}\n";
+}
+
+// reachable, unfinished positions from random play, each with one empty cell picked
+struct BenchPosition {
+    Board board;
+    int cell;
+};
+
+std::vector<BenchPosition> randomPositions(std::size_t count, std::uint64_t seed) {
+    std::vector<BenchPosition> positions;
+    RandomEngine engine(seed);
+    while (positions.size() < count) {
+        Board board;
+        Cell toMove = Cell::X;
+        auto [r,c] = engine.findBestMove(board);
+        int plies = r * Board::SIZE + c; // 0..8, reusing the engine as a dice roll
+        for (int i = 0; i < plies; ++i) {
+            auto [mr,mc] = engine.findBestMove(board);
+            if (board.makeMove(mr, mc, toMove) != MoveResult::Ongoing) { board.undoMove(mr, mc); break; }
+            toMove = opponent(toMove);
+        }
+        auto [er,ec] = engine.findBestMove(board);
+        positions.push_back({board, er * Board::SIZE + ec});
+    }
+    return positions;
+}
+
+void benchBoard() {
+    constexpr std::size_t COUNT = 256; // power of two, for cheap wrap-around
+    std::vector<BenchPosition> positions = randomPositions(COUNT, 17);
+    bench("board/make_undo_move", [&](std::uint64_t i) {
+        BenchPosition &p = positions[i & (COUNT - 1)];
+        int r = p.cell / Board::SIZE, c = p.cell % Board::SIZE;
+        benchSink = benchSink + (std::uint64_t)p.board.makeMove(r, c, Cell::X);
+        p.board.undoMove(r, c);
+    });
+    bench("board/check_winner", [&](std::uint64_t i) {
+        benchSink = benchSink + (std::uint64_t)positions[i & (COUNT - 1)].board.checkWinner().value_or(Cell::Empty);
+    });
+    bench("board/available_moves", [&](std::uint64_t i) {
+        benchSink = benchSink + (std::uint64_t)positions[i & (COUNT - 1)].board.availableMoves().size();
+    });
+    bench("board/is_full", [&](std::uint64_t i) {
+        benchSink = benchSink + positions[i & (COUNT - 1)].board.isFull();
+    });
+}
+
+// batched vs one-at-a-time outcome checks over every cell assignment, valid or not; per position
+void benchCheckWinners() {
+    std::vector<PackedBoard> boards;
+    for (std::uint32_t x = 0; x <= Board::FULL; ++x)
+        for (std::uint32_t o = 0; o <= Board::FULL; ++o)
+            if (!(x & o)) boards.push_back({x | o << 16});
+    std::vector<Outcome> out(boards.size());
+    std::size_t n = boards.size();
+    // each timed call covers n positions; report ns_per_op and iterations in positions
+    auto perPosition = [n](BenchResult &r) { r.nsPerOp /= n; r.iterations *= n; };
+    bench("board/check_winners_batched", [&](std::uint64_t) { Board::checkWinners(boards.data(), n, out.data()); });
+    perPosition(benchResults.back());
+    bench("board/check_winners_scalar", [&](std::uint64_t) { for (std::size_t i = 0; i < n; ++i) out[i] = outcomeOf(boards[i]); });
+    perPosition(benchResults.back());
+}
+
+// solved-table lookup, and tree search from an empty table, from positions with the
+// given side to move; the table clear before each search is not timed
+void benchFindBestMove(char const *position, Board board) {
+    Cell toMove = board.moveCount() % 2 == 0 ? Cell::X : Cell::O;
+    AI ai(toMove, opponent(toMove));
+    bench(std::string("ai/find_best_move/") + position, [&](std::uint64_t) {
+        benchSink = benchSink + (std::uint64_t)ai.findBestMove(board).first;
+    });
+    ai.setUseSolvedTable(false);
+    benchWithSetup(std::string("ai/search_cold_excl_clear/") + position, [&]{ ai.clearTable(); }, [&](std::uint64_t) {
+        benchSink = benchSink + (std::uint64_t)ai.findBestMove(board).first;
+    });
+}
+
+// search time from the empty board with empty tables, for 1, 2, 4, ... threads; the
+// clear before each search is not timed, since its cost grows with the thread count
+void benchParallelSearch(AI::Parallelism mode, const char *name) {
+    unsigned maxThreads = std::max(std::thread::hardware_concurrency(), 1u);
+    for (unsigned threads = 1; threads <= maxThreads; threads *= 2) {
+        AI ai(Cell::X, Cell::O);
+        ai.setUseSolvedTable(false);
+        ai.setParallelism(mode);
+        ai.setThreads((int)threads);
+        Board board;
+        benchWithSetup(std::string("ai/") + name + "_cold_excl_clear/empty", [&]{ ai.clearTable(); },
+                       [&](std::uint64_t) { ai.findBestMove(board); }, (int)threads);
+    }
+}
+
+// MCTS time per playout from the empty board with a fresh tree each time, for 1, 2, 4, ... threads
+void benchMcts(MCTS::Parallelism mode, const char *name) {
+    unsigned maxThreads = std::max(std::thread::hardware_concurrency(), 1u);
+    for (unsigned threads = 1; threads <= maxThreads; threads *= 2) {
+        double playouts = 0, seconds = 0;
+        for (int i = 0; i < 10; ++i) {
+            MCTS mcts(Cell::X);
+            mcts.setThreads((int)threads);
+            mcts.setParallelism(mode);
+            mcts.setIterations(100000);
+            mcts.findBestMove(Board());
+            playouts += (double)mcts.lastPlayouts();
+            seconds += mcts.lastPlayouts() / mcts.lastPlayoutsPerSecond();
+        }
+        benchResults.push_back({std::string("mcts/") + name + "/empty", seconds * 1e9 / playouts, (std::uint64_t)playouts, (int)threads});
+    }
+}
+
+int main() {
+    benchBoard();
+    benchCheckWinners();
+    benchFindBestMove("empty", Board());
+    // X centre and bottom-right, O top-left; O to move
+    benchFindBestMove("mid_game", Board::fromBits(0420, 0001));
+    // X threatens the middle column; O must block with four cells left
+    benchFindBestMove("near_terminal", Board::fromBits(0023, 0404));
+    benchParallelSearch(AI::Parallelism::LazySmp, "lazy_smp");
+    benchMcts(MCTS::Parallelism::Tree, "tree");
+    benchMcts(MCTS::Parallelism::Root, "root");
+    printBenchJson();
+    return 0;
+}
+#elif defined(TICTACTOE_SELFPLAY)
+// Headless engine-vs-engine games for the tictactoe_selfplay target
+
+struct SelfPlayOptions {
+    std::uint64_t games = 100000;
+    std::string engines[2] = {"minimax", "random"}; // X, O
+    int size = Board::SIZE;
+    std::uint64_t seed = 1;
+    int threads = (int)std::max(std::thread::hardware_concurrency(), 1u);
+    std::uint64_t mctsIterations = 1000;
+};
+
+// Per-move latency in nanoseconds, bucketed by power of two with 8 linear steps in each
+struct LatencyHistogram {
+    static constexpr int SUB = 8;
+    std::uint64_t buckets[64 * SUB] = {};
+    std::uint64_t count = 0;
+    double totalNanos = 0;
+
+    static int bucketOf(std::uint64_t ns) {
+        if (ns < SUB) return (int)ns;
+        int msb = 3;
+        while (ns >> (msb + 1)) ++msb;
+        return (msb - 2) * SUB + (int)((ns >> (msb - 3)) & (SUB - 1));
+    }
+    // smallest value that falls in the bucket above b
+    static double upperBound(int b) {
+        if (b < SUB) return b + 1;
+        int msb = b / SUB + 2;
+        return (double)((std::uint64_t)(SUB + b % SUB + 1) << (msb - 3));
+    }
+
+    void add(std::uint64_t ns) { ++buckets[bucketOf(ns)]; ++count; totalNanos += (double)ns; }
+    void merge(LatencyHistogram const &other) {
+        for (int i = 0; i < 64 * SUB; ++i) buckets[i] += other.buckets[i];
+        count += other.count;
+        totalNanos += other.totalNanos;
+    }
+    double percentile(double p) const {
+        std::uint64_t target = (std::uint64_t)std::ceil(p * count), seen = 0;
+        for (int i = 0; i < 64 * SUB; ++i) if ((seen += buckets[i]) >= target && seen) return upperBound(i);
+        return 0;
+    }
+};
+
+struct SelfPlayStats {
+    std::uint64_t xWins = 0, oWins = 0, draws = 0;
+    LatencyHistogram latency[2]; // X, O
+};
+
+std::unique_ptr<SearchEngine> makeSelfPlayEngine(std::string const &name, Cell player, SelfPlayOptions const &opts, std::uint64_t seed) {
+    if (name == "minimax") return std::make_unique<AI>(player, opponent(player));
+    // minimax answering from search alone, for latency numbers that measure the search
+    if (name == "minimax-search") {
+        auto ai = std::make_unique<AI>(player, opponent(player));
+        ai->setUseSolvedTable(false);
+        return ai;
+    }
+    if (name == "random") return std::make_unique<RandomEngine>(seed);
+    if (name == "mcts") {
+        auto mcts = std::make_unique<MCTS>(player, 1 << 16, seed);
+        mcts->setIterations(opts.mctsIterations);
+        return mcts;
+    }
+    return nullptr;
+}
+
+// each thread owns its engines and claims games from a shared counter; every
+// game reseeds them from --seed and its index, so which thread plays it does
+// not change the result
+SelfPlayStats runSelfPlay(SelfPlayOptions const &opts) {
+    std::vector<SelfPlayStats> perThread(opts.threads);
+    std::atomic<std::uint64_t> next{0};
+    auto work = [&](int thread) {
+        SelfPlayStats &stats = perThread[thread];
+        std::unique_ptr<SearchEngine> engines[2] = {
+            makeSelfPlayEngine(opts.engines[0], Cell::X, opts, opts.seed),
+            makeSelfPlayEngine(opts.engines[1], Cell::O, opts, opts.seed)};
+        for (std::uint64_t game; (game = next.fetch_add(1, std::memory_order_relaxed)) < opts.games;) {
+            std::uint64_t state = opts.seed + game;
+            std::uint64_t seed = splitMix64(state);
+            engines[0]->setSeed(seed);
+            engines[1]->setSeed(seed ^ 0xA5A5A5A5A5A5A5A5ull);
+            Board board;
+            Cell toMove = Cell::X;
+            for (;;) {
+                int side = toMove == Cell::X ? 0 : 1;
+                auto start = std::chrono::steady_clock::now();
+                auto [r,c] = engines[side]->findBestMove(board);
+                stats.latency[side].add((std::uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - start).count());
+                MoveResult result = board.makeMove(r, c, toMove);
+                if (result == MoveResult::Win) { ++(toMove == Cell::X ? stats.xWins : stats.oWins); break; }
+                if (result == MoveResult::Draw) { ++stats.draws; break; }
+                if (result == MoveResult::Illegal) { std::cerr << "illegal move from " << opts.engines[side] << "\n"; std::abort(); }
+                toMove = opponent(toMove);
+            }
+        }
+    };
+    ThreadPool pool(opts.threads);
+    pool.run(work);
+    SelfPlayStats total;
+    for (auto &s: perThread) {
+        total.xWins += s.xWins; total.oWins += s.oWins; total.draws += s.draws;
+        for (int i = 0; i < 2; ++i) total.latency[i].merge(s.latency[i]);
+    }
+    return total;
+}
+
+void printSelfPlayUsage() {
+    std::cerr << "usage: tictactoe_selfplay [--games N] [--x ENGINE] [--o ENGINE] [--size N] [--seed N]\n"
+                 "                          [--threads N] [--mcts-iterations N]\n"
+                 "engines: minimax, minimax-search (minimax without the solved table), mcts, random\n";
+}
+
+int main(int argc, char **argv) {
+    SelfPlayOptions opts;
+    for (int i = 1; i < argc; ++i) {
+        std::string flag = argv[i];
+        if (flag == "--help" || flag == "-h") { printSelfPlayUsage(); return 0; }
+        if (i + 1 >= argc) { printSelfPlayUsage(); return 1; }
+        std::string value = argv[++i];
+        char *end = nullptr;
+        unsigned long long n = std::strtoull(value.c_str(), &end, 10);
+        bool numeric = !value.empty() && *end == '\0';
+        if (flag == "--x" || flag == "--o") opts.engines[flag == "--x" ? 0 : 1] = value;
+        else if (!numeric) { printSelfPlayUsage(); return 1; }
+        else if (flag == "--games") opts.games = n;
+        else if (flag == "--size") opts.size = (int)n;
+        else if (flag == "--seed") opts.seed = n;
+        else if (flag == "--threads") opts.threads = std::clamp((int)std::min(n, 1024ull), 1, 1024);
+        else if (flag == "--mcts-iterations") opts.mctsIterations = std::max(n, 1ull);
+        else { printSelfPlayUsage(); return 1; }
+    }
+    if (opts.size != Board::SIZE) {
+        std::cerr << "only " << Board::SIZE << "x" << Board::SIZE << " boards are supported\n";
+        return 1;
+    }
+    for (auto &name: opts.engines)
+        if (!makeSelfPlayEngine(name, Cell::X, opts, 0)) { std::cerr << "unknown engine: " << name << "\n"; return 1; }
+
+    auto start = std::chrono::steady_clock::now();
+    SelfPlayStats stats = runSelfPlay(opts);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    double games = (double)std::max<std::uint64_t>(opts.games, 1);
+    std::cout << "games=" << opts.games << " threads=" << opts.threads << " seconds=" << seconds
+              << " games_per_sec=" << opts.games / seconds << "\n"
+              << "x=" << opts.engines[0] << " o=" << opts.engines[1]
+              << " x_win=" << stats.xWins / games << " draw=" << stats.draws / games
+              << " o_win=" << stats.oWins / games << "\n";
+    for (int i = 0; i < 2; ++i) {
+        LatencyHistogram const &h = stats.latency[i];
+        std::cout << (i == 0 ? "x" : "o") << "_move_us mean=" << (h.count ? h.totalNanos / h.count / 1000 : 0.0)
+                  << " p50=" << h.percentile(0.5) / 1000 << " p99=" << h.percentile(0.99) / 1000
+                  << " moves=" << h.count << "\n";
+    }
+    return 0;
+}
+#elif defined(TICTACTOE_PERFT)
+// Full game-tree walk for the tictactoe_perft target: positions per depth and
+// terminal totals, for checking Board's move generator and timing it
 
-            sf::Text sub("Click Restart or press R to play again", font, 16);
-            sub.setFillColor(sf::Color::White);
-            sf::FloatRect sbb = sub.getLocalBounds();
-            sub.setPosition((600 - sbb.width)/2.f, (600 - sbb.height)/2.f + 30);
-            window.draw(sub);
+// per-ply counts; games end at wins and draws, so deeper plies only see unfinished lines
+struct PerftCounts {
+    std::uint64_t positions[Board::SIZE*Board::SIZE + 1] = {};
+    std::uint64_t xWins[Board::SIZE*Board::SIZE + 1] = {};
+    std::uint64_t oWins[Board::SIZE*Board::SIZE + 1] = {};
+    std::uint64_t draws[Board::SIZE*Board::SIZE + 1] = {};
+
+    void merge(PerftCounts const &other) {
+        for (int d = 0; d <= Board::SIZE*Board::SIZE; ++d) {
+            positions[d] += other.positions[d];
+            xWins[d] += other.xWins[d];
+            oWins[d] += other.oWins[d];
+            draws[d] += other.draws[d];
         }
     }
 };
 
+// walks every line of play below board to depth plies from the start; ply is counted
+// from the start position
+void perft(Board &board, Cell toMove, int ply, int depth, PerftCounts &counts) {
+    if (ply == depth) return;
+    MoveList<Board::SIZE*Board::SIZE> moves = board.availableMoves();
+    for (int i = 0; i < moves.size(); ++i) {
+        auto [r,c] = moves[i];
+        MoveResult result = board.makeMove(r, c, toMove);
+        ++counts.positions[ply + 1];
+        if (result == MoveResult::Win) ++(toMove == Cell::X ? counts.xWins : counts.oWins)[ply + 1];
+        else if (result == MoveResult::Draw) ++counts.draws[ply + 1];
+        else perft(board, opponent(toMove), ply + 1, depth, counts);
+        board.undoMove(r, c);
+    }
+}
+
+// unfinished positions SPLIT_PLY plies below the start are handed out to threads
+constexpr int SPLIT_PLY = 2;
+
+void collectSplitPositions(Board &board, Cell toMove, int ply, int depth, PerftCounts &counts,
+                           std::vector<Board> &frontier) {
+    if (ply == std::min(SPLIT_PLY, depth)) { frontier.push_back(board); return; }
+    MoveList<Board::SIZE*Board::SIZE> moves = board.availableMoves();
+    for (int i = 0; i < moves.size(); ++i) {
+        auto [r,c] = moves[i];
+        MoveResult result = board.makeMove(r, c, toMove);
+        ++counts.positions[ply + 1];
+        if (result == MoveResult::Win) ++(toMove == Cell::X ? counts.xWins : counts.oWins)[ply + 1];
+        else if (result == MoveResult::Draw) ++counts.draws[ply + 1];
+        else collectSplitPositions(board, opponent(toMove), ply + 1, depth, counts, frontier);
+        board.undoMove(r, c);
+    }
+}
+
+PerftCounts runPerft(Board board, Cell toMove, int depth, ThreadPool *pool) {
+    PerftCounts counts;
+    if (!pool) {
+        perft(board, toMove, 0, depth, counts);
+        return counts;
+    }
+    std::vector<Board> frontier;
+    collectSplitPositions(board, toMove, 0, depth, counts, frontier);
+    int startPly = std::min(SPLIT_PLY, depth);
+    Cell frontierToMove = startPly % 2 == 0 ? toMove : opponent(toMove);
+    std::vector<PerftCounts> perThread(pool->size());
+    std::atomic<std::size_t> next{0};
+    auto work = [&](int thread) {
+        for (std::size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < frontier.size();)
+            perft(frontier[i], frontierToMove, startPly, depth, perThread[thread]);
+    };
+    pool->run(work);
+    for (auto &c: perThread) counts.merge(c);
+    return counts;
+}
+
+// nine characters, row by row: x, o or . for empty; X moves first
+std::optional<Board> parsePosition(std::string const &text) {
+    if ((int)text.size() != Board::SIZE*Board::SIZE) return std::nullopt;
+    unsigned x = 0, o = 0;
+    for (int i = 0; i < Board::SIZE*Board::SIZE; ++i) {
+        char ch = (char)std::tolower((unsigned char)text[i]);
+        if (ch == 'x') x |= 1u << i;
+        else if (ch == 'o') o |= 1u << i;
+        else if (ch != '.') return std::nullopt;
+    }
+    int diff = popCount(x) - popCount(o);
+    if (diff != 0 && diff != 1) return std::nullopt;
+    return Board::fromBits(x, o);
+}
+
+std::string formatPosition(Board const &board) {
+    std::string text;
+    for (int i = 0; i < Board::SIZE*Board::SIZE; ++i)
+        text += board.bits(Cell::X) >> i & 1 ? 'x' : board.bits(Cell::O) >> i & 1 ? 'o' : '.';
+    return text;
+}
+
+// every unfinished position reachable from board, once each
+void collectUnfinished(Board &board, Cell toMove, std::vector<bool> &seen, std::vector<Board> &out) {
+    unsigned code = board.bits(Cell::X) << (Board::SIZE*Board::SIZE) | board.bits(Cell::O);
+    if (seen[code]) return;
+    seen[code] = true;
+    out.push_back(board);
+    MoveList<Board::SIZE*Board::SIZE> moves = board.availableMoves();
+    for (int i = 0; i < moves.size(); ++i) {
+        auto [r,c] = moves[i];
+        if (board.makeMove(r, c, toMove) == MoveResult::Ongoing) collectUnfinished(board, opponent(toMove), seen, out);
+        board.undoMove(r, c);
+    }
+}
+
+// AI::search on threads threads, in every parallel mode, must choose the move the
+// single-threaded search does in every unfinished position; each search starts from
+// an empty table so a mismatch depends on the position alone. Returns the mismatches.
+int checkParallelSearch(int threads) {
+    struct Mode { AI::Parallelism mode; char const *name; };
+    Mode const modes[] = {{AI::Parallelism::RootSplit, "root_split"},
+                          {AI::Parallelism::YoungBrothersWait, "ybw"},
+                          {AI::Parallelism::LazySmp, "lazy_smp"}};
+    std::vector<bool> seen(1u << (2 * Board::SIZE*Board::SIZE));
+    std::vector<Board> positions;
+    Board empty;
+    collectUnfinished(empty, Cell::X, seen, positions);
+
+    // one engine of each kind per side to move, X first
+    std::unique_ptr<AI> single[2], parallel[2];
+    for (int side = 0; side < 2; ++side) {
+        Cell player = side == 0 ? Cell::X : Cell::O;
+        single[side] = std::make_unique<AI>(player, opponent(player));
+        parallel[side] = std::make_unique<AI>(player, opponent(player));
+        parallel[side]->setThreads(threads);
+    }
+    int total = 0;
+    for (Mode const &m: modes) {
+        int mismatches = 0;
+        for (auto &ai: parallel) ai->setParallelism(m.mode);
+        for (Board const &board: positions) {
+            int side = board.moveCount() % 2;
+            single[side]->clearTable();
+            parallel[side]->clearTable();
+            auto expected = single[side]->search(board), got = parallel[side]->search(board);
+            if (got == expected) continue;
+            if (++mismatches <= 10)
+                std::cout << m.name << " " << formatPosition(board) << " expected=" << expected.first << "," << expected.second
+                          << " got=" << got.first << "," << got.second << "\n";
+        }
+        std::cout << m.name << " positions=" << positions.size() << " threads=" << threads
+                  << " mismatches=" << mismatches << "\n";
+        total += mismatches;
+    }
+    std::cout << (total == 0 ? "ok" : "MISMATCH") << "\n";
+    return total;
+}
+
+void printPerftUsage() {
+    std::cerr << "usage: tictactoe_perft [--position XO.......] [--depth N] [--threads N] [--repeat N]\n"
+                 "       tictactoe_perft --check-parallel THREADS\n";
+}
+
+int main(int argc, char **argv) {
+    std::string position(Board::SIZE*Board::SIZE, '.');
+    int depth = Board::SIZE*Board::SIZE, threads = 1, repeat = 20, checkThreads = 0;
+    for (int i = 1; i < argc; ++i) {
+        std::string flag = argv[i];
+        if (flag == "--help" || flag == "-h") { printPerftUsage(); return 0; }
+        if (i + 1 >= argc) { printPerftUsage(); return 1; }
+        std::string value = argv[++i];
+        if (flag == "--position") { position = value; continue; }
+        char *end = nullptr;
+        long n = std::strtol(value.c_str(), &end, 10);
+        if (value.empty() || *end != '\0' || n < 0) { printPerftUsage(); return 1; }
+        if (flag == "--depth") depth = (int)std::min<long>(n, Board::SIZE*Board::SIZE);
+        else if (flag == "--threads") threads = (int)std::clamp<long>(n, 1, 1024);
+        else if (flag == "--repeat") repeat = (int)std::clamp<long>(n, 1, 1000000);
+        else if (flag == "--check-parallel") checkThreads = (int)std::clamp<long>(n, 2, 256);
+        else { printPerftUsage(); return 1; }
+    }
+    if (checkThreads) return checkParallelSearch(checkThreads) == 0 ? 0 : 1;
+    std::optional<Board> start = parsePosition(position);
+    if (!start) { std::cerr << "invalid position: " << position << "\n"; return 1; }
+    if (start->checkWinner() || start->isFull()) { std::cerr << "position is already decided\n"; return 1; }
+    Cell toMove = start->moveCount() % 2 == 0 ? Cell::X : Cell::O;
+    depth = std::min(depth, popCount(start->emptyBits()));
+
+    std::unique_ptr<ThreadPool> pool = threads > 1 ? std::make_unique<ThreadPool>(threads) : nullptr;
+    PerftCounts counts;
+    auto begin = std::chrono::steady_clock::now();
+    for (int i = 0; i < repeat; ++i) counts = runPerft(*start, toMove, depth, pool.get());
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count() / repeat;
+
+    std::uint64_t nodes = 0, xWins = 0, oWins = 0, draws = 0;
+    for (int d = 1; d <= depth; ++d) {
+        std::cout << "depth=" << d << " positions=" << counts.positions[d] << " x_wins=" << counts.xWins[d]
+                  << " o_wins=" << counts.oWins[d] << " draws=" << counts.draws[d] << "\n";
+        nodes += counts.positions[d];
+        xWins += counts.xWins[d];
+        oWins += counts.oWins[d];
+        draws += counts.draws[d];
+    }
+    std::uint64_t games = xWins + oWins + draws;
+    std::cout << "games=" << games << " x_wins=" << xWins << " o_wins=" << oWins << " draws=" << draws
+              << " nodes=" << nodes << " threads=" << threads << " seconds=" << seconds
+              << " nodes_per_sec=" << nodes / seconds << "\n";
+
+    // the full tree from the empty board has known totals
+    if (start->moveCount() == 0 && depth == Board::SIZE*Board::SIZE) {
+        bool ok = games == 255168 && xWins == 131184 && oWins == 77904 && draws == 46080;
+        std::cout << (ok ? "ok" : "MISMATCH: expected games=255168 x_wins=131184 o_wins=77904 draws=46080") << "\n";
+        return ok ? 0 : 1;
+    }
+    return 0;
+}
+#elif defined(TICTACTOE_RENDER_BENCH)
+// Offscreen rendering of a scripted game sequence for the tictactoe_render_bench target
+
+int main(int argc, char **argv) {
+    int frames = 5000;
+    std::string pngDir;
+    auto usage = []{ std::cerr << "usage: tictactoe_render_bench [--frames N] [--png-dir DIR]\n"; };
+    for (int i = 1; i < argc; ++i) {
+        std::string flag = argv[i];
+        if (flag == "--help" || flag == "-h") { usage(); return 0; }
+        if (i + 1 >= argc) { usage(); return 1; }
+        std::string value = argv[++i];
+        if (flag == "--png-dir") { pngDir = value; continue; }
+        char *end = nullptr;
+        long n = std::strtol(value.c_str(), &end, 10);
+        if (flag != "--frames" || value.empty() || *end != '\0' || n < 1) { usage(); return 1; }
+        frames = (int)std::min<long>(n, std::numeric_limits<int>::max());
+    }
+    Game game;
+    GUI gui(game, GUI::Output::Offscreen);
+    if (!gui.isOpen()) return 1;
+    GUI::ScriptTimings t = gui.runScript(frames, pngDir);
+    std::cout << "frames=" << t.frames << " seconds=" << t.seconds << " fps=" << t.frames / t.seconds
+              << " draw_calls=" << t.drawCalls << "\n"
+              << "ms_per_frame state=" << t.stateMs << " draw=" << t.drawMs << " present=" << t.presentMs
+              << " capture=" << t.captureMs << "\n";
+    return 0;
+}
+#else
 int main() {
     Game game;
     GUI gui(game);
     gui.run();
     return 0;
 }
+#endif
 
 --- assets/README.txt ---
 Place a TTF font in this folder and name it `font.ttf` (or change the path in the code to point to your font file).